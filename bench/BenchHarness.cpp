@@ -0,0 +1,114 @@
+#include "BenchHarness.h"
+
+namespace bench {
+
+volatile float sink = 0;
+
+Overhead timerOverhead() {
+    static bool measured = false;
+    static Overhead overhead = {0, 0};
+    if (measured) return overhead;
+
+    // Minimum over many runs, anything above it is attributed to the measured call
+    overhead = {UINT64_MAX, UINT64_MAX};
+    for (int i = 0; i < 1000; i++) {
+        uint64_t startCycles = nowCycles();
+        uint64_t startNs = nowNs();
+        uint64_t ns = nowNs() - startNs;
+        uint64_t cycles = nowCycles() - startCycles;
+        overhead.ns = min(overhead.ns, ns);
+        overhead.cycles = min(overhead.cycles, cycles);
+    }
+    measured = true;
+    return overhead;
+}
+
+void printHeader() {
+    char line[96];
+    snprintf(line, sizeof(line), "%-36s %9s %10s %12s", "benchmark", "calls", "ns/call", "cycles/call");
+    print(line);
+}
+
+void report(const char* name, uint32_t calls, uint64_t ns, uint64_t cycles) {
+    char line[96];
+    if (cycles > 0) {
+        snprintf(line, sizeof(line), "%-36s %9u %10.1f %12.1f",
+                 name, (unsigned)calls, (double)ns / calls, (double)cycles / calls);
+    } else {
+        snprintf(line, sizeof(line), "%-36s %9u %10.1f %12s",
+                 name, (unsigned)calls, (double)ns / calls, "-");
+    }
+    print(line);
+}
+
+}  // namespace bench
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#include <esp_timer.h>
+
+namespace bench {
+
+// 64-bit extension of the 32-bit CCOUNT, fine as long as calls to this are < 17s apart
+uint64_t nowCycles() {
+    static uint32_t last = 0;
+    static uint64_t high = 0;
+    uint32_t now = ESP.getCycleCount();
+    if (now < last) high += 1ULL << 32;
+    last = now;
+    return high | now;
+}
+
+uint64_t nowNs() { return nowCycles() * 1000 / getCpuFrequencyMhz(); }
+void advanceMs(uint32_t ms) { delay(ms); }
+void print(const char* line) { Serial.println(line); }
+
+}  // namespace bench
+
+void setup() {
+    Serial.begin(115200);
+    delay(2000);  // Give the monitor time to attach
+    Serial.println("Benchmarks @ " + String(getCpuFrequencyMhz()) + " MHz");
+    runAllBenchmarks();
+    Serial.println("Done");
+}
+
+void loop() {
+    delay(1000);
+}
+
+#else
+
+#include <chrono>
+#include "SimHardware.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t nowCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();  // TSC ticks, close to but not exactly core cycles
+#else
+    return 0;
+#endif
+}
+
+void advanceMs(uint32_t ms) { SimHardware::advanceUs(ms * 1000ULL); }
+void print(const char* line) { puts(line); }
+
+}  // namespace bench
+
+int main() {
+    SimHardware::reset();
+    runAllBenchmarks();
+    return 0;
+}
+
+#endif
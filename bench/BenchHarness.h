@@ -0,0 +1,73 @@
+#pragma once
+#include <Arduino.h>
+
+// Tiny timing harness shared by the native and on-target benchmark builds.
+// Native: ns from steady_clock, cycles from the TSC (x86 only).
+// ESP32: both derived from the CPU cycle counter.
+namespace bench {
+
+uint64_t nowNs();
+uint64_t nowCycles();     // 0 when the platform has no cycle counter
+void advanceMs(uint32_t ms);  // Simulated clock on native, real delay on target
+void print(const char* line);
+
+extern volatile float sink;  // Keeps results alive so calls aren't optimized away
+
+// Deterministic xorshift so both builds see the same input sequence
+class Random {
+    uint32_t state;
+
+public:
+    explicit Random(uint32_t seed) : state(seed ? seed : 1) {}
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    uint32_t range(uint32_t lo, uint32_t hi) { return lo + next() % (hi - lo + 1); }
+};
+
+void report(const char* name, uint32_t calls, uint64_t ns, uint64_t cycles);
+void printHeader();
+
+struct Overhead {
+    uint64_t ns;
+    uint64_t cycles;
+};
+Overhead timerOverhead();  // Cost of one empty start/stop pair, subtracted by runPerCall
+
+// Times `calls` back-to-back invocations as one block
+template<typename Fn>
+void runBatch(const char* name, uint32_t calls, Fn&& body) {
+    uint64_t startCycles = nowCycles();
+    uint64_t startNs = nowNs();
+    for (uint32_t i = 0; i < calls; i++) {
+        body(i);
+    }
+    uint64_t ns = nowNs() - startNs;
+    report(name, calls, ns, nowCycles() - startCycles);
+}
+
+// Times each call on its own, with untimed setup in between (clock advance etc.)
+template<typename Setup, typename Fn>
+void runPerCall(const char* name, uint32_t calls, Setup&& setup, Fn&& body) {
+    Overhead overhead = timerOverhead();
+    uint64_t totalNs = 0;
+    uint64_t totalCycles = 0;
+    for (uint32_t i = 0; i < calls; i++) {
+        setup(i);
+        uint64_t startCycles = nowCycles();
+        uint64_t startNs = nowNs();
+        body(i);
+        uint64_t ns = nowNs() - startNs;
+        uint64_t cycles = nowCycles() - startCycles;
+        totalNs += ns > overhead.ns ? ns - overhead.ns : 0;
+        totalCycles += cycles > overhead.cycles ? cycles - overhead.cycles : 0;
+    }
+    report(name, calls, totalNs, totalCycles);
+}
+
+}  // namespace bench
+
+void runAllBenchmarks();
@@ -0,0 +1,238 @@
+#include "BenchHarness.h"
+#include "config.h"
+#include "Motor.h"
+#include "MotorController.h"
+#include "DistanceSensors.h"
+#include "RobotLogic.h"
+#include "RobotState.h"
+#include "StuckDetector.h"
+#include "Odometry.h"
+#include "NavigationCurves.h"
+#include "navigation/ReactiveStrategy.h"
+#include "navigation/VfhStrategy.h"
+#include "navigation/OccupancyGrid.h"
+#include "navigation/SpeedGovernor.h"
+#include "SteeringMixer.h"
+#include "loggers/MessageFormatter.h"
+#include "sensors/RangeFilter.h"
+#include "sensors/SampleRing.h"
+
+#ifndef ARDUINO_ARCH_ESP32
+#include "SimHardware.h"
+#endif
+
+namespace {
+
+#ifdef ARDUINO_ARCH_ESP32
+// Clock-gated benchmarks really wait on target, keep them short
+constexpr uint32_t GATED_CALLS = 200;
+#else
+constexpr uint32_t GATED_CALLS = 5000;
+#endif
+constexpr uint32_t BATCH_CALLS = 100000;
+constexpr uint32_t FORMAT_CALLS = 10000;
+constexpr size_t INPUTS = 1024;
+
+// Sonar-like distribution: mostly mid range, some saturated (no echo), some close
+uint16_t sampleDistance(bench::Random& rng) {
+    uint32_t bucket = rng.range(0, 99);
+    if (bucket < 15) return MAX_SENSOR_DISTANCE;
+    if (bucket < 30) return rng.range(30, 300);
+    return rng.range(150, MAX_SENSOR_DISTANCE - 1);
+}
+
+struct Inputs {
+    uint16_t left[INPUTS];
+    uint16_t right[INPUTS];
+    uint16_t front[INPUTS];
+};
+
+}  // namespace
+
+void runAllBenchmarks() {
+    static Logger logger;  // Null logger, the chain ends here
+    static RobotState state(logger, MOTOR_SLEEP);  // Driver stays asleep on target
+    static Motor leftMotor(LEFT_MOTOR_IN1, LEFT_MOTOR_IN2, ENCODER_LEFT, logger);
+    static Motor rightMotor(RIGHT_MOTOR_IN1, RIGHT_MOTOR_IN2, ENCODER_RIGHT, logger);
+    static MotorController motors(leftMotor, rightMotor, MOTOR_FLT, state, logger);
+    static DistanceSensors sensors(logger);
+    static ReactiveStrategy reactive;
+    static StuckDetector detector(leftMotor, rightMotor, sensors);
+    static Inputs inputs;
+
+    bench::Random rng(12345);
+    for (size_t i = 0; i < INPUTS; i++) {
+        inputs.left[i] = sampleDistance(rng);
+        inputs.right[i] = sampleDistance(rng);
+        inputs.front[i] = sampleDistance(rng);
+    }
+    leftMotor.begin();
+    rightMotor.begin();
+
+    bench::printHeader();
+
+    bench::runBatch("ReactiveStrategy::calculateSteering", BATCH_CALLS, [&](uint32_t i) {
+        size_t k = i % INPUTS;
+        bench::sink = reactive.calculateSteering(inputs.left[k], inputs.right[k], inputs.front[k]);
+    });
+
+    bench::runBatch("ReactiveStrategy::calculateTargetSpeed", BATCH_CALLS, [&](uint32_t i) {
+        size_t k = i % INPUTS;
+        bench::sink = reactive.calculateTargetSpeed(inputs.front[k], inputs.left[k], inputs.right[k]);
+    });
+
+    // Worst case: memory full, every sensor fresh, so each call clears along three beams,
+    // adds three points and histograms all of them. Poses wander a little so points stay in range.
+    static VfhStrategy vfh;
+    static NavigationInputs navInputs[INPUTS];
+    for (size_t k = 0; k < INPUTS; k++) {
+        NavigationInputs& in = navInputs[k];
+        in.distance[LEFT_SENSOR] = inputs.left[k];
+        in.distance[RIGHT_SENSOR] = inputs.right[k];
+        in.distance[FRONT_SENSOR] = inputs.front[k];
+        for (bool& fresh : in.fresh) fresh = true;
+        in.pose = {(float)rng.range(0, 200) - 100, (float)rng.range(0, 200) - 100, rng.range(0, 628) / 100.0f - 3.14f};
+    }
+    for (size_t k = 0; k < INPUTS; k++) {
+        navInputs[k].nowMs = k;
+        vfh.decide(navInputs[k]);
+    }
+    bench::runBatch("VfhStrategy::decide (full memory)", BATCH_CALLS / 10, [&](uint32_t i) {
+        NavigationInputs& in = navInputs[i % INPUTS];
+        in.nowMs = INPUTS + i / 100;  // Slow clock, nothing ages out
+        bench::sink = vfh.decide(in).steering;
+    });
+
+    static SpeedGovernor governor;
+    for (size_t k = 0; k < INPUTS; k++) {
+        for (float& closing : navInputs[k].closing) closing = (float)rng.range(0, 800) - 200;
+    }
+    bench::runBatch("SpeedGovernor::limit", BATCH_CALLS, [&](uint32_t i) {
+        bench::sink = governor.limit(navInputs[i % INPUTS], 300, MAX_SPEED_PERCENT);
+    });
+
+    // Per reading cost grows with the beam length, the longest echo is the bound
+    static OccupancyGrid grid;
+    grid.recenter(0, 0);
+    bench::runBatch("OccupancyGrid::addReading (max range)", BATCH_CALLS / 10, [&](uint32_t i) {
+        float angle = (i % 628) / 100.0f;
+        grid.addReading(0, 0, cosf(angle), sinf(angle), MAX_SENSOR_DISTANCE - 1);
+    });
+
+    bench::runBatch("OccupancyGrid::recenter (one cell)", BATCH_CALLS / 10, [&](uint32_t i) {
+        grid.recenter((float)(i + 1) * OCCUPANCY_CELL_MM, 0);
+    });
+
+    // The closed forms NavigationCurves replaced, to keep the speedup visible
+    bench::runBatch("sigmoid speed, exp() reference", BATCH_CALLS, [&](uint32_t i) {
+        size_t k = i % INPUTS;
+        uint16_t minDistance = min(inputs.front[k], min(inputs.left[k], inputs.right[k]));
+        float normalized = 1.0f / (1.0f + exp(-SPEED_SIGMOID_SLOPE * (minDistance - SPEED_THRESHOLD_MM)));
+        bench::sink = (int)(MIN_SPEED_PERCENT + normalized * (MAX_SPEED_PERCENT - MIN_SPEED_PERCENT));
+    });
+
+    bench::runBatch("front amplification, pow() reference", BATCH_CALLS, [&](uint32_t i) {
+        float frontInfluence = 1.0f - constrain((float)inputs.front[i % INPUTS] / MAX_SENSOR_DISTANCE, 0.0f, 1.0f);
+        bench::sink = 1.0f + 4 * pow(frontInfluence, 4);
+    });
+
+    bench::runBatch("front amplification, table", BATCH_CALLS, [&](uint32_t i) {
+        bench::sink = NavigationCurves::frontAmplification(inputs.front[i % INPUTS]);
+    });
+
+    // update() only samples every STUCK_UPDATE_INTERVAL, advance the clock so every call does work
+    bench::advanceMs(STUCK_BACKUP_COOLDOWN);
+    bench::runPerCall("StuckDetector::update", GATED_CALLS,
+        [](uint32_t) { bench::advanceMs(STUCK_UPDATE_INTERVAL); },
+        [&](uint32_t) { detector.update(); });
+
+    bench::runBatch("StuckDetector::isStuck", BATCH_CALLS / 10, [&](uint32_t) {
+        bench::sink = detector.isStuck();
+    });
+
+    bench::runPerCall("Motor::update (new window)", GATED_CALLS,
+        [&](uint32_t) {
+            bench::advanceMs(MOTOR_UPDATE_INTERVAL);
+#ifndef ARDUINO_ARCH_ESP32
+            // Feed a realistic edge count through the real ISR
+            for (uint32_t p = rng.range(0, 20); p > 0; p--) SimHardware::pulse(ENCODER_LEFT);
+#endif
+        },
+        [&](uint32_t) { leftMotor.update(); });
+
+    // Period estimate walks the edge history on every call
+    bench::runBatch("Motor::getVelocityMmS", BATCH_CALLS, [&](uint32_t) {
+        bench::sink = leftMotor.getVelocityMmS();
+    });
+
+    // Steady cruise repeats the same duty every PID run, those writes are skipped
+    bench::runBatch("MotorController::applyPwm (unchanged)", BATCH_CALLS, [&](uint32_t) {
+        motors.applyPwm(0, 0);
+    });
+
+    bench::runPerCall("MotorController::applyPwm (changed)", GATED_CALLS,
+        [&](uint32_t) { bench::advanceMs(MOTOR_PWM_MIN_UPDATE_INTERVAL); },
+        [&](uint32_t i) { motors.applyPwm(300 + (i & 1) * 100, 300 + (i & 1) * 100); });
+    motors.applyPwm(0, 0);
+
+    // Open-loop steering path, float vs Q16.16 on the same inputs. The Q16 version
+    // is there to run without the FPU, not to be faster: on the host it isn't.
+    static SteeringMixer floatMixer;
+    static SteeringMixerQ16 fixedMixer;
+    floatMixer.setTarget(0.2f, 70);
+    fixedMixer.setTarget(0.2f, 70);
+    static float speeds[INPUTS];
+    static int32_t fixedSpeeds[INPUTS];
+    for (size_t k = 0; k < INPUTS; k++) {
+        speeds[k] = rng.range(0, 4000) / 10.0f;
+        fixedSpeeds[k] = SteeringMixerQ16::speed(speeds[k]);
+    }
+    bench::runBatch("SteeringMixer::update (float)", BATCH_CALLS, [&](uint32_t i) {
+        bench::sink = floatMixer.update(speeds[i % INPUTS], speeds[(i + 1) % INPUTS], STEERING_PID_INTERVAL_US).left;
+    });
+    bench::runBatch("SteeringMixerQ16::update", BATCH_CALLS, [&](uint32_t i) {
+        bench::sink = fixedMixer.update(fixedSpeeds[i % INPUTS], fixedSpeeds[(i + 1) % INPUTS],
+                                        STEERING_PID_INTERVAL_US).left;
+    });
+
+    static Odometry odometry(leftMotor, rightMotor);
+    bench::runPerCall("Odometry::update", GATED_CALLS,
+        [&](uint32_t) {
+            bench::advanceMs(1);
+#ifndef ARDUINO_ARCH_ESP32
+            for (uint32_t p = rng.range(0, 3); p > 0; p--) SimHardware::pulse(ENCODER_LEFT);
+            for (uint32_t p = rng.range(0, 3); p > 0; p--) SimHardware::pulse(ENCODER_RIGHT);
+#endif
+        },
+        [&](uint32_t) { odometry.update(); });
+
+    // Raw readings with the odd missing echo, one sensor frame apart
+    static RangeFilter filter;
+    bench::runBatch("RangeFilter::update", BATCH_CALLS, [&](uint32_t i) {
+        size_t k = i % INPUTS;
+        filter.update(inputs.front[k] == MAX_SENSOR_DISTANCE ? 0 : inputs.front[k], i * 12);
+        bench::sink = filter.getDistance();
+    });
+
+    // Full ring, approaching at ~300mm/s with sonar-like noise, one frame apart
+    static SampleRing<SENSOR_SAMPLE_RING> ring;
+    for (uint32_t i = 0; i < SENSOR_SAMPLE_RING; i++) {
+        ring.push(i * 12000, 900 - i * 4 + rng.range(0, 6));
+    }
+    bench::runBatch("SampleRing::fitSlope", BATCH_CALLS, [&](uint32_t) {
+        float slope = 0;
+        ring.fitSlope(SENSOR_PREDICT_WINDOW_MS * 1000UL, MAX_SENSOR_DISTANCE, 3, SENSOR_PREDICT_MAX_RESIDUAL, slope);
+        bench::sink = slope;
+    });
+
+    static const char* const messages[] = {
+        "Backing up for 1417ms",
+        "Front sensor - No echo",
+        "STUCK DETECTED! Starting backup maneuver",
+        "Calibration complete - L:0.79 R:1.00",
+    };
+    bench::runBatch("MessageFormatter::format", FORMAT_CALLS, [&](uint32_t i) {
+        String line = MessageFormatter::format(messages[i % 4], LogContext::Navigation, "INFO");
+        bench::sink = line.length();
+    });
+}
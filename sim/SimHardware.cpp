@@ -0,0 +1,97 @@
+#include "SimHardware.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <random>
+
+namespace {
+
+struct PinState {
+    int mode = INPUT;
+    int level = HIGH;
+    int pwm = 0;
+    void (*isr)(void*) = nullptr;
+    void* isrArg = nullptr;
+};
+
+uint64_t clockUs = 0;
+int pwmBits = 8;
+PinState pins[SimHardware::MAX_PINS];
+SimHardware::PingHandler pingHandler;
+std::mt19937 rng(1);
+
+PinState& pinState(int pin) {
+    return pins[pin >= 0 && pin < SimHardware::MAX_PINS ? pin : 0];
+}
+
+}  // namespace
+
+HardwareSerial Serial;
+EspClass ESP;
+
+uint64_t SimHardware::nowUs() { return clockUs; }
+void SimHardware::advanceUs(uint64_t us) { clockUs += us; }
+
+void SimHardware::reset() {
+    clockUs = 0;
+    pwmBits = 8;
+    for (PinState& pin : pins) pin = PinState();
+    pingHandler = nullptr;
+}
+
+void SimHardware::setPingHandler(PingHandler handler) { pingHandler = handler; }
+
+uint16_t SimHardware::ping(int trigPin, int echoPin) {
+    return pingHandler ? pingHandler(trigPin, echoPin) : 0;
+}
+
+uint32_t SimHardware::echoTimeUs(uint16_t distanceMm) {
+    // Round trip at 343 m/s
+    return (uint32_t)(distanceMm * 2 / 0.343f);
+}
+
+int SimHardware::getPwm(int pin) { return pinState(pin).pwm; }
+int SimHardware::getPwmMax() { return (1 << pwmBits) - 1; }
+int SimHardware::getLevel(int pin) { return pinState(pin).level; }
+void SimHardware::setLevel(int pin, int level) { pinState(pin).level = level; }
+
+void SimHardware::pulse(int pin) {
+    PinState& state = pinState(pin);
+    state.level = !state.level;
+    if (state.isr) state.isr(state.isrArg);
+}
+
+// Arduino core
+
+unsigned long millis() { return clockUs / 1000; }
+unsigned long micros() { return clockUs; }
+int64_t esp_timer_get_time() { return clockUs; }
+uint32_t EspClass::getCycleCount() { return (uint32_t)(clockUs * 240); }
+
+void delay(unsigned long ms) { clockUs += ms * 1000; }
+void delayMicroseconds(unsigned int us) { clockUs += us; }
+
+void pinMode(uint8_t pin, uint8_t mode) { pinState(pin).mode = mode; }
+void digitalWrite(uint8_t pin, uint8_t level) { pinState(pin).level = level; }
+int digitalRead(uint8_t pin) { return pinState(pin).level; }
+void analogWrite(uint8_t pin, int value) { pinState(pin).pwm = value; }
+void analogWriteResolution(uint8_t bits) { pwmBits = bits; }
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int) {
+    pinState(pin).isr = handler;
+    pinState(pin).isrArg = arg;
+}
+
+void detachInterrupt(uint8_t pin) {
+    pinState(pin).isr = nullptr;
+    pinState(pin).isrArg = nullptr;
+}
+
+long random(long howBig) {
+    return howBig > 0 ? std::uniform_int_distribution<long>(0, howBig - 1)(rng) : 0;
+}
+
+long random(long howSmall, long howBig) {
+    return howBig > howSmall ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+void randomSeed(unsigned long seed) { rng.seed(seed); }
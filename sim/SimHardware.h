@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+// Simulated clock and pin state behind the Arduino shim. The world model
+// reads motor PWM from here and feeds encoder edges and sonar echoes back.
+class SimHardware {
+public:
+    // Returns the measured distance in mm, 0 for no echo
+    using PingHandler = std::function<uint16_t(int trigPin, int echoPin)>;
+
+    static constexpr int MAX_PINS = 40;
+
+    static uint64_t nowUs();
+    static void advanceUs(uint64_t us);
+    static void reset();
+
+    static void setPingHandler(PingHandler handler);
+    static uint16_t ping(int trigPin, int echoPin);
+    static uint32_t echoTimeUs(uint16_t distanceMm);
+
+    static int getPwm(int pin);
+    static int getPwmMax();
+    static int getLevel(int pin);
+    static void setLevel(int pin, int level);
+    static void pulse(int pin);  // One encoder edge: toggle the pin and run its ISR
+};
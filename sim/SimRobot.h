@@ -0,0 +1,42 @@
+#pragma once
+#include "config.h"
+#include "Motor.h"
+#include "MotorController.h"
+#include "DistanceSensors.h"
+#include "RobotLogic.h"
+#include "RobotState.h"
+#include "loggers/SerialLogger.h"
+#include "loggers/LogLevelDecorator.h"
+
+// The firmware object graph from main.cpp, minus WiFi/HTTP/OTA, with the
+// control task body as tick()
+struct SimRobot {
+    SerialLogger serialLogger;
+    LogLevelDecorator logger;
+    RobotState state;
+    Motor leftMotor;
+    Motor rightMotor;
+    MotorController motors;
+    DistanceSensors sensors;
+    RobotLogic robot;
+
+    explicit SimRobot(LogLevel level)
+        : logger(&serialLogger, level),
+          state(logger, MOTOR_SLEEP),
+          leftMotor(LEFT_MOTOR_IN1, LEFT_MOTOR_IN2, ENCODER_LEFT, logger),
+          rightMotor(RIGHT_MOTOR_IN1, RIGHT_MOTOR_IN2, ENCODER_RIGHT, logger),
+          motors(leftMotor, rightMotor, MOTOR_FLT, state, logger),
+          sensors(logger),
+          robot(motors, sensors, logger, state) {}
+
+    void begin() {
+        robot.begin();
+    }
+
+    void tick() {
+        sensors.setMotionHint(motors.getSpeedPercent(), motors.getSteering());
+        sensors.update();
+        motors.update();
+        robot.update();
+    }
+};
@@ -0,0 +1,266 @@
+#include "World.h"
+#include "SimHardware.h"
+#include "config.h"
+#include <cmath>
+
+namespace {
+
+struct SensorMount {
+    int trigPin;
+    float forward;  // Offset from robot centre along heading
+    float lateral;  // Offset to the left
+    float angle;    // Relative to heading
+};
+
+const SensorMount SENSOR_MOUNTS[] = {
+    {LEFT_TRIG_PIN, 60.0f, 40.0f, 0.785f},
+    {RIGHT_TRIG_PIN, 60.0f, -40.0f, -0.785f},
+    {FRONT_TRIG_PIN, 70.0f, 0.0f, 0.0f},
+};
+
+float distanceToSegment(float px, float py, const World::Segment& s) {
+    float dx = s.x2 - s.x1;
+    float dy = s.y2 - s.y1;
+    float lengthSq = dx * dx + dy * dy;
+    float t = lengthSq > 0 ? ((px - s.x1) * dx + (py - s.y1) * dy) / lengthSq : 0;
+    t = std::fmax(0.0f, std::fmin(1.0f, t));
+    float cx = s.x1 + t * dx - px;
+    float cy = s.y1 + t * dy - py;
+    return std::sqrt(cx * cx + cy * cy);
+}
+
+}  // namespace
+
+World::World(uint32_t seed) : rng(seed) {}
+
+void World::addWall(float x1, float y1, float x2, float y2) {
+    walls.push_back({x1, y1, x2, y2});
+}
+
+void World::addBox(float x, float y, float width, float height) {
+    addWall(x, y, x + width, y);
+    addWall(x + width, y, x + width, y + height);
+    addWall(x + width, y + height, x, y + height);
+    addWall(x, y + height, x, y);
+}
+
+bool World::loadPreset(World& world, const std::string& name) {
+    if (name == "room") {
+        world.addBox(0, 0, 4000, 3000);
+        world.addBox(1200, 900, 500, 400);
+        world.addBox(2600, 1800, 400, 600);
+        world.setPose({600, 600, 0.3f});
+    } else if (name == "corridor") {
+        // L-shaped corridor, 700mm wide, closed at both ends
+        world.addWall(0, 0, 5000, 0);
+        world.addWall(5000, 0, 5000, 4000);
+        world.addWall(5000, 4000, 4300, 4000);
+        world.addWall(4300, 4000, 4300, 700);
+        world.addWall(4300, 700, 0, 700);
+        world.addWall(0, 700, 0, 0);
+        world.setPose({400, 350, 0.0f});
+    } else if (name == "clutter") {
+        world.addBox(0, 0, 5000, 4000);
+        const float boxes[][4] = {
+            {800, 700, 300, 300}, {2000, 500, 250, 600}, {3300, 900, 400, 300},
+            {1200, 2200, 600, 250}, {2600, 2500, 300, 300}, {3900, 2600, 250, 700},
+            {600, 3200, 300, 300}, {2100, 1500, 200, 200},
+        };
+        for (const auto& b : boxes) world.addBox(b[0], b[1], b[2], b[3]);
+        world.setPose({400, 400, 0.5f});
+    } else {
+        return false;
+    }
+    return true;
+}
+
+float World::wheelCommand(int in1Pin, int in2Pin) const {
+    if (SimHardware::getLevel(MOTOR_SLEEP) == LOW || timeUs < faultUntilUs) {
+        return 0;  // Driver asleep or tripped
+    }
+    return (float)(SimHardware::getPwm(in1Pin) - SimHardware::getPwm(in2Pin)) / SimHardware::getPwmMax();
+}
+
+float World::wheelTarget(float command, float gain) const {
+    float magnitude = std::fabs(command);
+    if (magnitude < PWM_DEADBAND) {
+        return 0;
+    }
+    float speed = (magnitude - PWM_DEADBAND) / (1.0f - PWM_DEADBAND) * MAX_WHEEL_SPEED_MM_S * gain;
+    return command > 0 ? speed : -speed;
+}
+
+bool World::collides(float x, float y) const {
+    for (const Segment& wall : walls) {
+        if (distanceToSegment(x, y, wall) < ROBOT_RADIUS_MM) return true;
+    }
+    return false;
+}
+
+float World::wallDistance(float x, float y) const {
+    float closest = INFINITY;
+    for (const Segment& wall : walls) {
+        closest = std::fmin(closest, distanceToSegment(x, y, wall));
+    }
+    return closest;
+}
+
+void World::emitEdges(int wheel, int encoderPin, float distanceMm) {
+    // Same encoder geometry as the firmware assumes
+    edgeAccumulator[wheel] += std::fabs(distanceMm) * ENCODER_EDGES_PER_MM;
+    while (edgeAccumulator[wheel] >= 1.0f) {
+        edgeAccumulator[wheel] -= 1.0f;
+        SimHardware::pulse(encoderPin);
+    }
+}
+
+void World::checkOvercurrent(const float commands[2]) {
+    const float gains[2] = {LEFT_WHEEL_GAIN, RIGHT_WHEEL_GAIN};
+    for (int i = 0; i < 2; i++) {
+        float backEmf = wheelSpeed[i] / (MAX_WHEEL_SPEED_MM_S * gains[i]);
+        if (std::fabs(commands[i] - backEmf) > OVERCURRENT_TRIP) {
+            faultTrips++;
+            faultUntilUs = timeUs + FAULT_LATCH_US;
+            return;
+        }
+    }
+}
+
+void World::step(uint32_t dtUs) {
+    timeUs += dtUs;
+    float dt = dtUs / 1000000.0f;
+    float alpha = std::fmin(1.0f, dt / WHEEL_TIME_CONSTANT_S);
+    float commands[2] = {
+        wheelCommand(LEFT_MOTOR_IN1, LEFT_MOTOR_IN2),
+        wheelCommand(RIGHT_MOTOR_IN1, RIGHT_MOTOR_IN2),
+    };
+    checkOvercurrent(commands);
+    SimHardware::setLevel(MOTOR_FLT, timeUs < faultUntilUs ? LOW : HIGH);
+    if (timeUs < faultUntilUs) {
+        commands[0] = commands[1] = 0;
+    }
+    float targets[2] = {
+        wheelTarget(commands[0], LEFT_WHEEL_GAIN),
+        wheelTarget(commands[1], RIGHT_WHEEL_GAIN),
+    };
+    float maxChange = TRACTION_ACCEL_MM_S2 * dt;
+    for (int i = 0; i < 2; i++) {
+        wheelSpeed[i] += (targets[i] - wheelSpeed[i]) * alpha;
+        float change = std::fmax(-maxChange, std::fmin(maxChange, wheelSpeed[i] - groundSpeed[i]));
+        groundSpeed[i] += change;
+        slipDistance += std::fabs(wheelSpeed[i] - groundSpeed[i]) * dt;
+    }
+
+    float linear = (groundSpeed[0] + groundSpeed[1]) / 2.0f;
+    float angular = (groundSpeed[1] - groundSpeed[0]) / WHEEL_BASE_MM;
+    float heading = pose.theta + angular * dt / 2.0f;
+    float nx = pose.x + linear * std::cos(heading) * dt;
+    float ny = pose.y + linear * std::sin(heading) * dt;
+
+    float realized[2];
+    if (!collides(nx, ny)) {
+        pose = {nx, ny, pose.theta + angular * dt};
+        // Encoders see the wheel, slipping or not
+        realized[0] = wheelSpeed[0];
+        realized[1] = wheelSpeed[1];
+        distanceTravelled += std::fabs(linear) * dt;
+        blocked = false;
+    } else {
+        // Against a wall: the robot can still turn in place, wheels stall otherwise
+        blockedSteps++;
+        if (!blocked && std::fabs(linear) >= IMPACT_MIN_SPEED_MM_S) {
+            impacts++;
+            impactSpeedSum += std::fabs(linear);
+            reverseImpacts += linear < 0;
+        }
+        blocked = true;
+        pose.theta += angular * dt;
+        realized[0] = -angular * WHEEL_BASE_MM / 2.0f;
+        realized[1] = angular * WHEEL_BASE_MM / 2.0f;
+        wheelSpeed[0] = groundSpeed[0] = realized[0];
+        wheelSpeed[1] = groundSpeed[1] = realized[1];
+    }
+    pose.theta = std::remainder(pose.theta, 2.0f * (float)M_PI);
+
+    emitEdges(0, ENCODER_LEFT, realized[0] * dt);
+    emitEdges(1, ENCODER_RIGHT, realized[1] * dt);
+}
+
+float World::raycast(float x, float y, float angle) const {
+    float dx = std::cos(angle);
+    float dy = std::sin(angle);
+    float best = INFINITY;
+    for (const Segment& wall : walls) {
+        float sx = wall.x2 - wall.x1;
+        float sy = wall.y2 - wall.y1;
+        float denom = dx * sy - dy * sx;
+        if (std::fabs(denom) < 1e-6f) continue;
+        float t = ((wall.x1 - x) * sy - (wall.y1 - y) * sx) / denom;
+        float u = ((wall.x1 - x) * dy - (wall.y1 - y) * dx) / denom;
+        if (t <= 0 || u < 0 || u > 1 || t >= best) continue;
+
+        // Specular surfaces: steep hits don't return an echo
+        float incidence = std::acos(std::fabs(denom) / std::sqrt(sx * sx + sy * sy));
+        if (incidence > SONAR_MAX_INCIDENCE_RAD) continue;
+        best = t;
+    }
+    return best;
+}
+
+float World::sonarRange(int mountIndex) const {
+    const SensorMount& mount = SENSOR_MOUNTS[mountIndex];
+    float c = std::cos(pose.theta);
+    float s = std::sin(pose.theta);
+    float x = pose.x + mount.forward * c - mount.lateral * s;
+    float y = pose.y + mount.forward * s + mount.lateral * c;
+
+    // The nearest return inside the cone wins, like on the real sensor
+    float nearest = INFINITY;
+    for (int i = 0; i < SONAR_RAYS; i++) {
+        float offset = -SONAR_HALF_CONE_RAD + 2.0f * SONAR_HALF_CONE_RAD * i / (SONAR_RAYS - 1);
+        nearest = std::fmin(nearest, raycast(x, y, pose.theta + mount.angle + offset));
+    }
+    return nearest;
+}
+
+float World::trueRange(int trigPin) const {
+    for (int m = 0; m < SONAR_COUNT; m++) {
+        if (SENSOR_MOUNTS[m].trigPin == trigPin) return sonarRange(m);
+    }
+    return INFINITY;
+}
+
+uint16_t World::ping(int trigPin) {
+    for (int m = 0; m < SONAR_COUNT; m++) {
+        const SensorMount& mount = SENSOR_MOUNTS[m];
+        if (mount.trigPin != trigPin) continue;
+
+        float nearest = sonarRange(m);
+        lastPingUs[m] = timeUs;
+        lastPingRange[m] = nearest > SONAR_MAX_RANGE_MM ? 0 : nearest;
+
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+        // A neighbour's ping still in flight can reach this receiver first. It
+        // shows up early by the trigger offset; sensors facing apart rarely hear it.
+        for (int other = 0; other < SONAR_COUNT; other++) {
+            uint64_t sinceUs = timeUs - lastPingUs[other];
+            if (other == m || lastPingRange[other] == 0 || sinceUs > SONAR_CROSSTALK_WINDOW_US) continue;
+            float apparent = lastPingRange[other] - sinceUs * 0.1715f;
+            float facing = std::cos(mount.angle - SENSOR_MOUNTS[other].angle);
+            if (apparent < 20.0f || apparent >= nearest) continue;
+            if (uniform(rng) < SONAR_CROSSTALK * std::fmax(0.0f, facing * facing * facing)) {
+                crosstalkEchoes++;
+                return (uint16_t)std::lround(apparent);
+            }
+        }
+
+        if (nearest > SONAR_MAX_RANGE_MM || uniform(rng) < SONAR_DROPOUT) {
+            return 0;
+        }
+        std::normal_distribution<float> noise(0.0f, SONAR_NOISE_MM + SONAR_NOISE_RATIO * nearest);
+        float measured = std::fmax(20.0f, nearest + noise(rng));
+        return (uint16_t)std::lround(measured);
+    }
+    return 0;
+}
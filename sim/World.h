@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// 2D world for the host simulator: line-segment walls, a differential-drive
+// robot with first-order wheel dynamics, encoder edges and HC-SR04 style
+// ray-cast echoes with noise and dropouts. Units are mm, seconds, radians.
+//
+// Wheels can slip: the ground speed follows the wheel with limited traction,
+// encoders count the wheel. The driver trips on overcurrent, taken as drive
+// voltage minus back-EMF, and then coasts with its fault line low for a while.
+class World {
+public:
+    struct Pose {
+        float x;
+        float y;
+        float theta;  // CCW from +x
+    };
+
+    struct Segment {
+        float x1, y1, x2, y2;
+    };
+
+    // Robot model, roughly matched to the real chassis
+    static constexpr float WHEEL_BASE_MM = 140.0f;
+    static constexpr float ROBOT_RADIUS_MM = 100.0f;
+    static constexpr float MAX_WHEEL_SPEED_MM_S = 450.0f;  // At full PWM
+    static constexpr float PWM_DEADBAND = 0.15f;           // Fraction of full PWM
+    static constexpr float WHEEL_TIME_CONSTANT_S = 0.08f;
+    static constexpr float LEFT_WHEEL_GAIN = 1.25f;        // Left motor is stronger
+    static constexpr float RIGHT_WHEEL_GAIN = 1.0f;
+    static constexpr float TRACTION_ACCEL_MM_S2 = 3000.0f; // Faster changes spin the wheel
+    static constexpr float OVERCURRENT_TRIP = 1.1f;        // (PWM - back-EMF) as a fraction of full scale
+    static constexpr uint32_t FAULT_LATCH_US = 50000;      // Outputs off, FLT low
+    static constexpr float IMPACT_MIN_SPEED_MM_S = 50.0f;  // Slower contact is a scrape, not an impact
+
+    // Sonar model
+    static constexpr float SONAR_HALF_CONE_RAD = 0.13f;    // ~7.5 degrees
+    static constexpr int SONAR_RAYS = 7;
+    static constexpr float SONAR_MAX_INCIDENCE_RAD = 0.8f; // Steeper hits reflect away
+    static constexpr float SONAR_NOISE_MM = 2.0f;
+    static constexpr float SONAR_NOISE_RATIO = 0.01f;      // Extra noise per mm of range
+    static constexpr float SONAR_DROPOUT = 0.03f;          // Probability of a missing echo
+    static constexpr float SONAR_MAX_RANGE_MM = 4000.0f;
+    static constexpr float SONAR_CROSSTALK = 0.25f;        // Chance to hear a neighbour's ping still in flight
+    static constexpr uint32_t SONAR_CROSSTALK_WINDOW_US = 8000;
+    static constexpr int SONAR_COUNT = 3;
+
+    explicit World(uint32_t seed);
+
+    static bool loadPreset(World& world, const std::string& name);
+
+    void addWall(float x1, float y1, float x2, float y2);
+    void addBox(float x, float y, float width, float height);
+    void setPose(const Pose& p) { pose = p; }
+
+    void step(uint32_t dtUs);
+    uint16_t ping(int trigPin);
+    float trueRange(int trigPin) const;  // Noise-free, INFINITY when nothing is hit
+    float wallDistance(float x, float y) const;  // To the closest wall, INFINITY without walls
+
+    const Pose& getPose() const { return pose; }
+    float getDistanceTravelled() const { return distanceTravelled; }
+    float getForwardSpeed() const { return (groundSpeed[0] + groundSpeed[1]) / 2.0f; }  // mm/s
+    uint64_t getBlockedSteps() const { return blockedSteps; }
+    uint32_t getImpacts() const { return impacts; }  // Runs into a wall, not scrapes
+    float getImpactSpeedSum() const { return impactSpeedSum; }  // mm/s, summed over the impacts
+    uint32_t getReverseImpacts() const { return reverseImpacts; }  // Of those, backing into a wall
+    uint32_t getCrosstalkEchoes() const { return crosstalkEchoes; }
+    uint32_t getFaultTrips() const { return faultTrips; }
+    float getSlipDistance() const { return slipDistance; }  // mm of wheel travel not matched by the ground
+
+private:
+    std::vector<Segment> walls;
+    Pose pose = {0, 0, 0};
+    float wheelSpeed[2] = {0, 0};      // Left, right in mm/s
+    float groundSpeed[2] = {0, 0};     // What the wheels actually move the robot at
+    uint64_t faultUntilUs = 0;
+    uint32_t faultTrips = 0;
+    float slipDistance = 0;
+    float edgeAccumulator[2] = {0, 0};
+    float distanceTravelled = 0;
+    uint64_t blockedSteps = 0;
+    bool blocked = false;
+    uint32_t impacts = 0;
+    float impactSpeedSum = 0;
+    uint32_t reverseImpacts = 0;
+    uint64_t timeUs = 0;
+    uint64_t lastPingUs[SONAR_COUNT] = {0};
+    float lastPingRange[SONAR_COUNT] = {0};  // True range of the last ping, 0 = no echo
+    uint32_t crosstalkEchoes = 0;
+    std::mt19937 rng;
+
+    float wheelCommand(int in1Pin, int in2Pin) const;  // Signed PWM fraction
+    float wheelTarget(float command, float gain) const;
+    void checkOvercurrent(const float commands[2]);
+    bool collides(float x, float y) const;
+    float raycast(float x, float y, float angle) const;
+    float sonarRange(int mountIndex) const;
+    void emitEdges(int wheel, int encoderPin, float distanceMm);
+};
@@ -0,0 +1,343 @@
+// Host simulator: runs the navigation stack against World with a simulated
+// clock, so a 10 minute drive finishes in seconds.
+//
+//   pio run -e native_sim && .pio/build/native_sim/program --world clutter --duration 600
+//
+// Options: --world room|corridor|clutter  --duration <s>  --seed <n>
+//          --ranging concurrent|sequential  --schedule adaptive|equal
+//          --drive openloop|velocity  --slew off|smooth|fast  --nav reactive|vfh
+//          --governor on|off
+//          --trace <csv>  --grid <file>  --verbose
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "SimHardware.h"
+#include "SimRobot.h"
+#include "World.h"
+
+namespace {
+
+constexpr uint32_t WORLD_SUBSTEPS = 10;  // World integration steps per control tick
+
+struct RmsError {
+    double sumSquares = 0;
+    uint64_t count = 0;
+    void add(double error) { sumSquares += error * error; count++; }
+    double rms() const { return count ? sqrt(sumSquares / count) : 0; }
+};
+
+// Dead-reckoning error over fixed segments, re-anchored to the true pose after each
+struct OdometryDrift {
+    static constexpr uint64_t SEGMENT_US = 10000000;
+    World::Pose worldStart = {0, 0, 0};
+    Odometry::Pose odometryStart = {0, 0, 0};
+    uint64_t startUs = 0;
+    bool anchored = false;
+    RmsError position, heading;
+
+    void update(uint64_t nowUs, const World::Pose& truth, const Odometry::Pose& odometry) {
+        if (anchored && nowUs - startUs < SEGMENT_US) return;
+        if (anchored) {
+            // Odometry displacement rotated into the world frame at the anchor
+            double rotation = worldStart.theta - odometryStart.theta;
+            double dx = odometry.x - odometryStart.x;
+            double dy = odometry.y - odometryStart.y;
+            double ex = worldStart.x + dx * cos(rotation) - dy * sin(rotation) - truth.x;
+            double ey = worldStart.y + dx * sin(rotation) + dy * cos(rotation) - truth.y;
+            position.add(hypot(ex, ey));
+            double turnError = (odometry.theta - odometryStart.theta) - (truth.theta - worldStart.theta);
+            heading.add(remainder(turnError, 2 * M_PI) * 180 / M_PI);
+        }
+        worldStart = truth;
+        odometryStart = odometry;
+        startUs = nowUs;
+        anchored = true;
+    }
+};
+
+struct Options {
+    std::string world = "room";
+    float duration = 600.0f;
+    uint32_t seed = 1;
+    RangingMode ranging = SENSOR_RANGING_CONCURRENT ? RangingMode::Concurrent : RangingMode::Sequential;
+    const char* schedule = nullptr;  // Firmware default
+    DriveMode drive = DRIVE_VELOCITY_CONTROL ? DriveMode::Velocity : DriveMode::OpenLoop;
+    SlewProfile slew = static_cast<SlewProfile>(MOTOR_SLEW_PROFILE);
+    NavigationMode nav = NAV_VFH ? NavigationMode::Vfh : NavigationMode::Reactive;
+    bool governor = GOVERNOR_ENABLED;
+    const char* trace = nullptr;
+    const char* grid = nullptr;  // Occupancy grid blob at the end, as /navigation/grid serves it
+    bool verbose = false;
+};
+
+bool parseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--world") && hasValue) {
+            options.world = argv[++i];
+        } else if (!strcmp(argv[i], "--duration") && hasValue) {
+            options.duration = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && hasValue) {
+            options.seed = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--ranging") && hasValue) {
+            const char* mode = argv[++i];
+            if (!strcmp(mode, "concurrent")) {
+                options.ranging = RangingMode::Concurrent;
+            } else if (!strcmp(mode, "sequential")) {
+                options.ranging = RangingMode::Sequential;
+            } else {
+                fprintf(stderr, "Unknown ranging mode: %s\n", mode);
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--schedule") && hasValue) {
+            options.schedule = argv[++i];
+            if (strcmp(options.schedule, "adaptive") && strcmp(options.schedule, "equal")) {
+                fprintf(stderr, "Unknown schedule: %s\n", options.schedule);
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--drive") && hasValue) {
+            const char* mode = argv[++i];
+            if (!strcmp(mode, "openloop")) {
+                options.drive = DriveMode::OpenLoop;
+            } else if (!strcmp(mode, "velocity")) {
+                options.drive = DriveMode::Velocity;
+            } else {
+                fprintf(stderr, "Unknown drive mode: %s\n", mode);
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--slew") && hasValue) {
+            const char* profile = argv[++i];
+            if (!strcmp(profile, "off")) {
+                options.slew = SlewProfile::Off;
+            } else if (!strcmp(profile, "smooth")) {
+                options.slew = SlewProfile::Smooth;
+            } else if (!strcmp(profile, "fast")) {
+                options.slew = SlewProfile::Fast;
+            } else {
+                fprintf(stderr, "Unknown slew profile: %s\n", profile);
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--nav") && hasValue) {
+            const char* strategy = argv[++i];
+            if (!strcmp(strategy, "reactive")) {
+                options.nav = NavigationMode::Reactive;
+            } else if (!strcmp(strategy, "vfh")) {
+                options.nav = NavigationMode::Vfh;
+            } else {
+                fprintf(stderr, "Unknown navigation strategy: %s\n", strategy);
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--governor") && hasValue) {
+            const char* value = argv[++i];
+            if (!strcmp(value, "on")) {
+                options.governor = true;
+            } else if (!strcmp(value, "off")) {
+                options.governor = false;
+            } else {
+                fprintf(stderr, "Unknown governor setting: %s\n", value);
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--trace") && hasValue) {
+            options.trace = argv[++i];
+        } else if (!strcmp(argv[i], "--grid") && hasValue) {
+            options.grid = argv[++i];
+        } else if (!strcmp(argv[i], "--verbose")) {
+            options.verbose = true;
+        } else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Occupied grid cells checked against the walls, using the current odometry to
+// world offset so drift accumulated earlier doesn't count against the map
+struct GridAccuracy {
+    static constexpr uint64_t INTERVAL_US = 10000000;
+    static constexpr float TOLERANCE_MM = 75;  // Half a cell diagonal plus sonar noise
+    uint64_t lastUs = 0;
+    uint64_t occupied = 0;
+    uint64_t onWall = 0;
+    uint32_t samples = 0;
+
+    void update(uint64_t nowUs, const World& world, const Odometry::Pose& odometry, const OccupancyGrid& grid) {
+        if (nowUs - lastUs < INTERVAL_US) return;
+        lastUs = nowUs;
+        static uint8_t blob[OccupancyGrid::BLOB_BYTES];
+        grid.writeBlob(blob);
+        int16_t originX = blob[4] | (blob[5] << 8);
+        int16_t originY = blob[6] | (blob[7] << 8);
+        const World::Pose& truth = world.getPose();
+        float rotation = truth.theta - odometry.theta;
+        for (int row = 0; row < OccupancyGrid::SIZE; row++) {
+            for (int col = 0; col < OccupancyGrid::SIZE; col++) {
+                uint8_t pair = blob[OccupancyGrid::HEADER_BYTES + (row * OccupancyGrid::SIZE + col) / 2];
+                int logOdds = (col & 1 ? pair >> 4 : pair & 0x0F) - 8;
+                if (logOdds < OCCUPANCY_OCCUPIED) continue;
+                float dx = (originX + col + 0.5f) * OCCUPANCY_CELL_MM - odometry.x;
+                float dy = (originY + row + 0.5f) * OCCUPANCY_CELL_MM - odometry.y;
+                float x = truth.x + dx * cos(rotation) - dy * sin(rotation);
+                float y = truth.y + dx * sin(rotation) + dy * cos(rotation);
+                occupied++;
+                onWall += world.wallDistance(x, y) <= TOLERANCE_MM;
+            }
+        }
+        samples++;
+    }
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        return 2;
+    }
+
+    SimHardware::reset();
+    randomSeed(options.seed);
+
+    World world(options.seed);
+    if (!World::loadPreset(world, options.world)) {
+        fprintf(stderr, "Unknown world: %s\n", options.world.c_str());
+        return 2;
+    }
+    SimHardware::setPingHandler([&world](int trigPin, int) { return world.ping(trigPin); });
+
+    SimRobot sim(options.verbose ? LogLevel::Info : LogLevel::Warning);
+    sim.begin();
+    sim.sensors.setRangingMode(options.ranging);
+    sim.motors.setDriveMode(options.drive);
+    sim.motors.setSlewProfile(options.slew);
+    sim.robot.setNavigationMode(options.nav);
+    sim.robot.setGovernorEnabled(options.governor);
+    EqualSchedule equalSchedule;
+    AdaptiveSchedule adaptiveSchedule;
+    if (options.schedule) {
+        if (!strcmp(options.schedule, "equal")) {
+            sim.sensors.setSchedulePolicy(equalSchedule);
+        } else {
+            sim.sensors.setSchedulePolicy(adaptiveSchedule);
+        }
+    }
+    sim.state.setAutoSwitchEnabled(false);
+    sim.state.setMode(OperationMode::Auto);
+
+    FILE* trace = options.trace ? fopen(options.trace, "w") : nullptr;
+    if (trace) fprintf(trace, "t,x,y,theta,front,left,right,speed,steering,backup\n");
+
+    const uint64_t endUs = (uint64_t)(options.duration * 1000000.0f);
+    uint32_t backups = 0;
+    int64_t firstStuckUs = -1;
+    bool wasBackingUp = false;
+    RmsError readingError, predictedError;
+    RmsError cruiseReadingError, cruisePredictedError;
+    OdometryDrift odometryDrift;
+    GridAccuracy gridAccuracy;
+    RmsError speedError;  // Commanded vs actual forward speed while driving
+    uint64_t governorTicks[4] = {0};  // By GovernorState, while driving forward
+    auto wallStart = std::chrono::steady_clock::now();
+
+    while (SimHardware::nowUs() < endUs) {
+        for (uint32_t i = 0; i < WORLD_SUBSTEPS; i++) {
+            SimHardware::advanceUs(CONTROL_TICK_US / WORLD_SUBSTEPS);
+            world.step(CONTROL_TICK_US / WORLD_SUBSTEPS);
+        }
+        sim.tick();
+
+        // Range error at the moment navigation runs, front sensor, obstacles in range
+        float actual = world.trueRange(FRONT_TRIG_PIN);
+        uint16_t lastReading = sim.sensors.getFrontDistance();
+        uint16_t predicted = sim.sensors.predictDistance(FRONT_SENSOR, micros());
+        if (actual < MAX_SENSOR_DISTANCE - 100 && lastReading < MAX_SENSOR_DISTANCE) {
+            readingError.add(lastReading - actual);
+            predictedError.add(predicted - actual);
+            if (sim.motors.getSpeedPercent() >= SCHED_CRUISE_SPEED) {
+                cruiseReadingError.add(lastReading - actual);
+                cruisePredictedError.add(predicted - actual);
+            }
+        }
+
+        odometryDrift.update(SimHardware::nowUs(), world.getPose(), sim.robot.getOdometry().getPose());
+        gridAccuracy.update(SimHardware::nowUs(), world, sim.robot.getOdometry().getPose(), sim.robot.getOccupancyGrid());
+
+        bool backingUp = sim.robot.getBackupTimeRemaining() > 0;
+        if (!backingUp && sim.motors.getSpeedPercent() > 0) {
+            governorTicks[static_cast<int>(sim.robot.getGovernor().getState())]++;
+            speedError.add(world.getForwardSpeed() - sim.motors.getSpeedPercent() / 100.0f * WHEEL_MAX_SPEED_MM_S);
+        }
+        if (backingUp && !wasBackingUp) {
+            backups++;
+            if (firstStuckUs < 0) firstStuckUs = SimHardware::nowUs();
+        }
+        wasBackingUp = backingUp;
+
+        if (trace && SimHardware::nowUs() % 50000 == 0) {
+            const World::Pose& p = world.getPose();
+            fprintf(trace, "%.3f,%.1f,%.1f,%.3f,%u,%u,%u,%.1f,%.3f,%d\n",
+                    SimHardware::nowUs() / 1e6, p.x, p.y, p.theta,
+                    sim.sensors.getFrontDistance(), sim.sensors.getLeftDistance(),
+                    sim.sensors.getRightDistance(), sim.motors.getSpeedPercent(),
+                    sim.motors.getSteering(), backingUp ? 1 : 0);
+        }
+    }
+    if (trace) fclose(trace);
+    if (options.grid) {
+        static uint8_t blob[OccupancyGrid::BLOB_BYTES];
+        size_t length = sim.robot.getOccupancyGrid().writeBlob(blob);
+        FILE* file = fopen(options.grid, "wb");
+        if (file) {
+            fwrite(blob, 1, length, file);
+            fclose(file);
+        }
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double simSeconds = SimHardware::nowUs() / 1e6;
+
+    printf("world:            %s (seed %u)\n", options.world.c_str(), options.seed);
+    printf("navigation:       %s\n", sim.robot.getNavigationName());
+    uint64_t drivingTicks = governorTicks[0] + governorTicks[1] + governorTicks[2] + governorTicks[3];
+    if (options.governor && drivingTicks > 0) {
+        printf("governor:         limiting %.0f%%, cruise %.0f%% of the time driving\n",
+               100.0 * governorTicks[static_cast<int>(GovernorState::Limiting)] / drivingTicks,
+               100.0 * governorTicks[static_cast<int>(GovernorState::Cruise)] / drivingTicks);
+    } else {
+        printf("governor:         off\n");
+    }
+    printf("simulated:        %.1f s in %.2f s wall (%.0fx)\n", simSeconds, wallSeconds, simSeconds / wallSeconds);
+    if (firstStuckUs >= 0) {
+        printf("time to stuck:    %.1f s\n", firstStuckUs / 1e6);
+    } else {
+        printf("time to stuck:    never\n");
+    }
+    printf("backups:          %u (%.1f per hour)\n", backups, backups * 3600.0 / simSeconds);
+    printf("average speed:    %.1f mm/s\n", world.getDistanceTravelled() / simSeconds);
+    printf("blocked time:     %.1f s\n", world.getBlockedSteps() * (CONTROL_TICK_US / WORLD_SUBSTEPS) / 1e6);
+    printf("impacts:          %u, %.0f mm/s average, %u reversing\n", world.getImpacts(),
+           world.getImpacts() ? world.getImpactSpeedSum() / world.getImpacts() : 0.0f, world.getReverseImpacts());
+    printf("sensor frames:    %.1f per s (%s)\n", sim.sensors.getFrameCount() / simSeconds,
+           options.ranging == RangingMode::Concurrent ? "concurrent" : "sequential");
+    printf("crosstalk:        %u injected, %u rejected\n", world.getCrosstalkEchoes(),
+           sim.sensors.getCrosstalkRejections());
+    printf("outliers gated:   %u\n", sim.sensors.getOutlierRejections());
+    printf("front error rms:  %.1f mm last reading, %.1f mm predicted\n", readingError.rms(), predictedError.rms());
+    printf("  at cruise:      %.1f mm last reading, %.1f mm predicted\n", cruiseReadingError.rms(), cruisePredictedError.rms());
+    printf("refresh (%s):  front %.1f, left %.1f, right %.1f per s\n", sim.sensors.getScheduleName(),
+           sim.sensors.getReadingCount(FRONT_SENSOR) / simSeconds,
+           sim.sensors.getReadingCount(LEFT_SENSOR) / simSeconds,
+           sim.sensors.getReadingCount(RIGHT_SENSOR) / simSeconds);
+    printf("speed error rms:  %.1f mm/s (%s)\n", speedError.rms(),
+           options.drive == DriveMode::Velocity ? "velocity" : "open loop");
+    printf("odometry drift:   %.1f mm, %.1f deg rms per %.0f s\n", odometryDrift.position.rms(),
+           odometryDrift.heading.rms(), OdometryDrift::SEGMENT_US / 1e6);
+    printf("driver faults:    %u trips, %.0f mm wheel slip\n", world.getFaultTrips(), world.getSlipDistance());
+    printf("occupancy grid:   %u echoes, %.0f cells occupied, %.0f%% on a wall\n",
+           sim.robot.getOccupancyGrid().getUpdates(),
+           gridAccuracy.samples ? (double)gridAccuracy.occupied / gridAccuracy.samples : 0.0,
+           gridAccuracy.occupied ? 100.0 * gridAccuracy.onWall / gridAccuracy.occupied : 0.0);
+    return 0;
+}
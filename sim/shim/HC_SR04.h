@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+#include "../SimHardware.h"
+
+// Stand-in for the HC_SR04 library. The echo arrives after the simulated
+// time of flight, so timing in DistanceSensors behaves like on the robot.
+template<int ECHO_PIN>
+class HC_SR04 {
+private:
+    const int trigPin;
+    uint64_t finishedAtUs = 0;
+    uint16_t distance = 0;
+
+public:
+    explicit HC_SR04(int trig) : trigPin(trig) {}
+
+    bool beginAsync() { return true; }
+
+    void startAsync(uint32_t timeoutUs) {
+        uint64_t now = SimHardware::nowUs();
+        distance = SimHardware::ping(trigPin, ECHO_PIN);
+        uint32_t echoUs = SimHardware::echoTimeUs(distance);
+        if (distance == 0 || echoUs > timeoutUs) {
+            distance = 0;
+            finishedAtUs = now + timeoutUs;
+        } else {
+            finishedAtUs = now + echoUs;
+        }
+    }
+
+    bool isFinished() const { return SimHardware::nowUs() >= finishedAtUs; }
+    uint16_t getDist_mm() const { return distance; }
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// In-memory NVS, lives for the process so a second begin() sees earlier writes
+class Preferences {
+    using Namespace = std::map<std::string, std::vector<uint8_t>>;
+    Namespace* current = nullptr;
+    bool readOnly = false;
+
+    static std::map<std::string, Namespace>& storage() {
+        static std::map<std::string, Namespace> namespaces;
+        return namespaces;
+    }
+
+    size_t put(const char* key, const void* value, size_t length) {
+        if (!current || readOnly) return 0;
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        (*current)[key].assign(bytes, bytes + length);
+        return length;
+    }
+
+    template <typename T>
+    T get(const char* key, T defaultValue) const {
+        T value = defaultValue;
+        if (current) {
+            auto it = current->find(key);
+            if (it != current->end() && it->second.size() == sizeof(T)) memcpy(&value, it->second.data(), sizeof(T));
+        }
+        return value;
+    }
+
+public:
+    bool begin(const char* name, bool ro = false) {
+        auto& namespaces = storage();
+        if (ro && namespaces.find(name) == namespaces.end()) return false;
+        current = &namespaces[name];
+        readOnly = ro;
+        return true;
+    }
+    void end() { current = nullptr; }
+    bool clear() { if (!current || readOnly) return false; current->clear(); return true; }
+    bool remove(const char* key) { return current && !readOnly && current->erase(key) > 0; }
+    bool isKey(const char* key) const { return current && current->count(key) > 0; }
+
+    size_t putUChar(const char* key, uint8_t value) { return put(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return put(key, &value, sizeof(value)); }
+    size_t putBytes(const char* key, const void* value, size_t length) { return put(key, value, length); }
+
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) const { return get(key, defaultValue); }
+    float getFloat(const char* key, float defaultValue = 0) const { return get(key, defaultValue); }
+    size_t getBytesLength(const char* key) const {
+        if (!current) return 0;
+        auto it = current->find(key);
+        return it == current->end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buffer, size_t maxLength) const {
+        size_t length = getBytesLength(key);
+        if (length == 0 || length > maxLength) return 0;
+        memcpy(buffer, current->find(key)->second.data(), length);
+        return length;
+    }
+};
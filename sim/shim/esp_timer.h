@@ -0,0 +1,5 @@
+#pragma once
+#include <cstdint>
+
+// Simulated esp_timer clock, shares the time base with millis()/micros()
+int64_t esp_timer_get_time();
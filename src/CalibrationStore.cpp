@@ -0,0 +1,78 @@
+#include "CalibrationStore.h"
+#include <Preferences.h>
+
+namespace {
+const char* NVS_NAMESPACE = "motorcal";
+}
+
+bool CalibrationStore::loadCurve(Preferences& prefs, const char* key, SpeedCurve& curve) {
+    // PWM percents first, then speeds
+    float data[2 * SpeedCurve::MAX_POINTS];
+    size_t length = prefs.getBytesLength(key);
+    if (length == 0 || length > sizeof(data) || length % (2 * sizeof(float)) != 0) {
+        return false;
+    }
+    prefs.getBytes(key, data, length);
+    size_t points = length / (2 * sizeof(float));
+    return curve.setPoints(data, data + points, points);
+}
+
+bool CalibrationStore::saveCurve(Preferences& prefs, const char* key, const SpeedCurve& curve) {
+    if (!curve.isValid()) {
+        prefs.remove(key);
+        return true;
+    }
+    float data[2 * SpeedCurve::MAX_POINTS];
+    size_t points = curve.size();
+    for (size_t i = 0; i < points; i++) {
+        data[i] = curve.getPwmPercent(i);
+        data[points + i] = curve.getSpeed(i);
+    }
+    size_t length = 2 * points * sizeof(float);
+    return prefs.putBytes(key, data, length) == length;
+}
+
+bool CalibrationStore::load(Calibration& calibration) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) {
+        return false;  // Nothing stored yet
+    }
+    if (prefs.getUChar("version", 0) != FORMAT_VERSION) {
+        prefs.end();
+        return false;
+    }
+    Calibration loaded;
+    loaded.leftScale = prefs.getFloat("lscale", DEFAULT_LEFT_MOTOR_SCALE);
+    loaded.rightScale = prefs.getFloat("rscale", DEFAULT_RIGHT_MOTOR_SCALE);
+    loadCurve(prefs, "lcurve", loaded.leftCurve);
+    loadCurve(prefs, "rcurve", loaded.rightCurve);
+    prefs.end();
+
+    calibration = loaded;
+    return true;
+}
+
+bool CalibrationStore::save(const Calibration& calibration) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = prefs.putFloat("lscale", calibration.leftScale) > 0 &&
+              prefs.putFloat("rscale", calibration.rightScale) > 0 &&
+              saveCurve(prefs, "lcurve", calibration.leftCurve) &&
+              saveCurve(prefs, "rcurve", calibration.rightCurve);
+    // Version last, a half written set is never picked up
+    if (ok) {
+        ok = prefs.putUChar("version", FORMAT_VERSION) > 0;
+    }
+    prefs.end();
+    return ok;
+}
+
+void CalibrationStore::clear() {
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.clear();
+        prefs.end();
+    }
+}
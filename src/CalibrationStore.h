@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+#include "SpeedCurve.h"
+#include "config.h"
+
+class Preferences;
+
+// Motor calibration in NVS, so a reboot doesn't need another calibration run.
+// Bump FORMAT_VERSION when the layout changes, older data is then ignored.
+class CalibrationStore {
+public:
+    struct Calibration {
+        float leftScale = DEFAULT_LEFT_MOTOR_SCALE;
+        float rightScale = DEFAULT_RIGHT_MOTOR_SCALE;
+        SpeedCurve leftCurve;
+        SpeedCurve rightCurve;
+    };
+
+    bool load(Calibration& calibration);  // false leaves calibration untouched
+    bool save(const Calibration& calibration);
+    void clear();
+
+private:
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
+    static bool loadCurve(Preferences& prefs, const char* key, SpeedCurve& curve);
+    static bool saveCurve(Preferences& prefs, const char* key, const SpeedCurve& curve);
+};
@@ -0,0 +1,45 @@
+#include "ControlLink.h"
+
+bool ControlLink::begin() {
+    commandQueue = xQueueCreate(COMMAND_QUEUE_LENGTH, sizeof(RobotCommand));
+    return commandQueue != nullptr;
+}
+
+bool ControlLink::sendCommand(const RobotCommand& command) {
+    if (!commandQueue) return false;
+    return xQueueSend(commandQueue, &command, 0) == pdTRUE;
+}
+
+bool ControlLink::receiveCommand(RobotCommand& command) {
+    if (!commandQueue) return false;
+    return xQueueReceive(commandQueue, &command, 0) == pdTRUE;
+}
+
+void ControlLink::publishTelemetry(const RobotTelemetry& snapshot) {
+    portENTER_CRITICAL(&telemetryLock);
+    telemetry = snapshot;
+    portEXIT_CRITICAL(&telemetryLock);
+}
+
+RobotTelemetry ControlLink::readTelemetry() {
+    portENTER_CRITICAL(&telemetryLock);
+    RobotTelemetry snapshot = telemetry;
+    portEXIT_CRITICAL(&telemetryLock);
+    return snapshot;
+}
+
+void ControlLink::publishGrid(const OccupancyGrid& grid) {
+    grid.writeBlob(gridScratch);
+    portENTER_CRITICAL(&gridLock);
+    memcpy(gridBlob, gridScratch, sizeof(gridBlob));
+    gridPublished = true;
+    portEXIT_CRITICAL(&gridLock);
+}
+
+bool ControlLink::readGrid(uint8_t* out) {
+    portENTER_CRITICAL(&gridLock);
+    bool published = gridPublished;
+    if (published) memcpy(out, gridBlob, sizeof(gridBlob));
+    portEXIT_CRITICAL(&gridLock);
+    return published;
+}
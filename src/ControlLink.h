@@ -0,0 +1,125 @@
+#pragma once
+#include <Arduino.h>
+#include "RobotState.h"
+#include "MotorController.h"
+#include "DistanceSensors.h"
+#include "Odometry.h"
+#include "RobotLogic.h"
+#include "config.h"
+
+// Hand-off between the network task (core 0) and the control task (core 1).
+//
+// - Commands flow network -> control through a FreeRTOS queue. The network side
+//   never touches MotorController/RobotLogic/RobotState directly; the control
+//   task drains the queue at the start of every tick and applies the commands.
+// - Telemetry flows control -> network as a snapshot struct. The control task
+//   publishes a full copy once per tick, the network side reads a full copy.
+//   Both copies happen under a spinlock, so readers never see a torn snapshot.
+// - The occupancy grid is too big to copy every tick, it is published as a
+//   blob every OCCUPANCY_PUBLISH_INTERVAL under its own lock.
+
+enum class CommandType {
+    SetSpeed,
+    SetSteering,
+    Stop,
+    SetMode,
+    Calibrate,
+    TestMotors,
+    TestBackup,
+    SetRangingMode,
+    ResetOdometry,
+    SetDriveMode,
+    ClearCalibration,
+    SetSlewProfile,
+    SetNavigationMode,
+    SetSpeedGovernor
+};
+
+struct RobotCommand {
+    CommandType type;
+    float value = 0;                          // Speed percent / steering ratio / governor on (1) or off (0)
+    OperationMode mode = OperationMode::Off;  // Target mode for SetMode
+    RangingMode ranging = RangingMode::Concurrent;  // Target for SetRangingMode
+    DriveMode drive = DriveMode::OpenLoop;          // Target for SetDriveMode
+    SlewProfile slew = SlewProfile::Smooth;         // Target for SetSlewProfile
+    NavigationMode navigation = NavigationMode::Reactive;  // Target for SetNavigationMode
+};
+
+struct RobotTelemetry {
+    OperationMode mode = OperationMode::Off;
+    uint16_t frontDistance = 0;
+    uint16_t leftDistance = 0;
+    uint16_t rightDistance = 0;
+    uint32_t captureLatencyUs[NUM_SENSORS] = {0};  // Per sensor, indexed by SensorIndex
+    uint16_t rawDistance[NUM_SENSORS] = {0};       // Before RangeFilter
+    float sensorConfidence[NUM_SENSORS] = {0};     // 0-1
+    uint32_t sensorAgeMs[NUM_SENSORS] = {0};       // Since the last accepted reading
+    RangingMode rangingMode = RangingMode::Concurrent;
+    float sensorFrameRate = 0;       // Full three-sensor frames per second
+    uint32_t sensorFrames = 0;
+    uint32_t crosstalkRejections = 0;
+    uint32_t outlierRejections = 0;  // Dropped by the rate gate
+    const char* scheduleName = "";   // Static string from the SchedulePolicy
+    float refreshRateHz[NUM_SENSORS] = {0};
+    float speedPercent = 0;
+    float steering = 0;
+    DriveMode driveMode = DriveMode::OpenLoop;
+    float leftSpeed = 0;             // mm/s
+    float rightSpeed = 0;
+    float leftTargetSpeed = 0;       // mm/s, velocity drive mode only
+    float rightTargetSpeed = 0;
+    Odometry::Pose pose = {0, 0, 0};
+    float linearVelocity = 0;        // mm/s
+    float angularVelocity = 0;       // rad/s
+    float odometryDistance = 0;      // mm since the last reset
+    const char* navigationName = ""; // Static string from the NavigationStrategy
+    float vfhDirection = 0;          // rad off the heading, positive left
+    uint16_t vfhPoints = 0;          // Obstacles remembered
+    uint32_t gridReadings = 0;       // Echoes in the occupancy grid since the last reset
+    const char* governorState = "";  // Static string from the SpeedGovernor
+    uint32_t ttcMs = 0;              // Shortest time to collision over the sensors
+    float closing[NUM_SENSORS] = {0};  // mm/s, > 0 when the gap shrinks
+    int governorSensor = -1;         // SensorIndex the cap comes from, -1 = none
+    int governorCapPercent = 0;
+    float leftScale = DEFAULT_LEFT_MOTOR_SCALE;
+    float rightScale = DEFAULT_RIGHT_MOTOR_SCALE;
+    SpeedCurve leftCurve;            // Empty until calibrated
+    SpeedCurve rightCurve;
+    bool calibrationStored = false;  // Scales/curves are in NVS
+    bool stuck = false;
+    int backupRemaining = 0;
+    CalibrationStatus calibrationStatus = CalibrationStatus::Idle;
+    uint8_t calibrationProgress = 0; // 0-100
+    uint32_t tickOverruns = 0;       // Control ticks that ran past the next tick
+    uint32_t tickMissed = 0;         // Control ticks dropped entirely
+    uint32_t pidMissed = 0;          // PID periods skipped
+    uint32_t pidDtUs = 0;            // Measured dt of the last PID run
+    uint32_t pwmSkipped = 0;         // Motor duty writes dropped as redundant
+    SlewProfile slewProfile = SlewProfile::Smooth;
+    uint32_t motorFaults = 0;        // Driver fault line going low
+    unsigned long publishedAt = 0;   // millis() of the snapshot
+};
+
+class ControlLink {
+private:
+    QueueHandle_t commandQueue = nullptr;
+    portMUX_TYPE telemetryLock = portMUX_INITIALIZER_UNLOCKED;
+    RobotTelemetry telemetry;
+    portMUX_TYPE gridLock = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t gridBlob[OccupancyGrid::BLOB_BYTES];
+    uint8_t gridScratch[OccupancyGrid::BLOB_BYTES];  // Control side, filled outside the lock
+    bool gridPublished = false;
+
+public:
+    bool begin();
+
+    // Network side
+    bool sendCommand(const RobotCommand& command);  // Non-blocking, false if queue is full
+    RobotTelemetry readTelemetry();
+    bool readGrid(uint8_t* out);  // OccupancyGrid::BLOB_BYTES, false before the first publish
+
+    // Control side
+    bool receiveCommand(RobotCommand& command);     // Non-blocking, false if queue is empty
+    void publishTelemetry(const RobotTelemetry& snapshot);
+    void publishGrid(const OccupancyGrid& grid);
+};
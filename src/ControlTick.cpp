@@ -0,0 +1,46 @@
+#include "ControlTick.h"
+
+void ControlTick::onTimer(void* arg) {
+    ControlTick* tick = static_cast<ControlTick*>(arg);
+    tick->tickCount++;
+    xTaskNotifyGive(tick->task);
+}
+
+bool ControlTick::begin() {
+    task = xTaskGetCurrentTaskHandle();
+
+    esp_timer_create_args_t args = {};
+    args.callback = &ControlTick::onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "control_tick";
+
+    if (esp_timer_create(&args, &timer) == ESP_OK && esp_timer_start_periodic(timer, periodUs) == ESP_OK) {
+        return true;
+    }
+    if (timer) {
+        esp_timer_delete(timer);
+        timer = nullptr;
+    }
+    fallback = true;
+    lastWake = xTaskGetTickCount();
+    return false;
+}
+
+void ControlTick::wait() {
+    if (fallback) {
+        // Nothing notifies the task, pace on the scheduler tick instead
+        TickType_t period = max((TickType_t)1, (TickType_t)pdMS_TO_TICKS(periodUs / 1000));
+        vTaskDelayUntil(&lastWake, period);
+        tickCount++;
+        return;
+    }
+    // Ticks that arrived while the previous iteration was still running
+    uint32_t pending = ulTaskNotifyTake(pdTRUE, 0);
+    if (pending > 0) {
+        overruns++;
+        missedTicks += pending - 1;
+        return;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
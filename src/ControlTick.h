@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Fixed-rate tick for the control task, driven by esp_timer instead of the
+// 1ms FreeRTOS tick. The timer callback only notifies the waiting task, so all
+// control code still runs in task context.
+//
+// Overrun: the previous tick's work was still running when the next tick fired.
+// Missed: ticks that fired while the work was running and were dropped entirely.
+//
+// If the timer can't be started, wait() falls back to vTaskDelayUntil() on the
+// FreeRTOS tick, coarser (whole ticks) but the loop keeps running.
+class ControlTick {
+private:
+    esp_timer_handle_t timer = nullptr;
+    TaskHandle_t task = nullptr;
+    const uint32_t periodUs;
+    volatile uint32_t tickCount = 0;
+    uint32_t overruns = 0;
+    uint32_t missedTicks = 0;
+    bool fallback = false;
+    TickType_t lastWake = 0;
+
+    static void onTimer(void* arg);
+
+public:
+    explicit ControlTick(uint32_t period) : periodUs(period) {}
+
+    bool begin();  // Must be called from the task that waits on the tick, false = fallback pacing
+    void wait();
+
+    uint32_t getPeriodUs() const { return periodUs; }
+    uint32_t getTickCount() const { return tickCount; }
+    uint32_t getOverruns() const { return overruns; }
+    uint32_t getMissedTicks() const { return missedTicks; }
+    bool isFallback() const { return fallback; }
+};
@@ -9,70 +9,349 @@ bool DistanceSensors::begin() {
     if (!success) {
         logger.error("Failed to initialize distance sensors", LogContext::Sensor);
     }
+    rateWindowStart = millis();
     return success;
 }
 
 void DistanceSensors::update() {
+    if (rangingMode == RangingMode::Concurrent) {
+        updateConcurrent();
+    } else {
+        updateSequential();
+    }
+}
+
+void DistanceSensors::setRangingMode(RangingMode mode) {
+    if (mode == rangingMode) return;
+    rangingMode = mode;
+
+    // Drop whatever is in flight and let stray echoes die down before the next trigger
     unsigned long now = millis();
-    
-    if (!measurementStarted && now >= nextMeasurementTime) {
-        switch(currentSensor) {
-            case LEFT_SENSOR:
-                leftSensor.startAsync(SENSOR_READ_TIMEOUT * 1000);
-                nextMeasurementTime = now + SENSOR_CYCLE_TIME;  // Wait full 60ms before next sensor
-                break;
-            case RIGHT_SENSOR:
-                rightSensor.startAsync(SENSOR_READ_TIMEOUT * 1000);
-                nextMeasurementTime = now + SENSOR_CYCLE_TIME;
-                break;
-            case FRONT_SENSOR:
-                frontSensor.startAsync(SENSOR_READ_TIMEOUT * 1000);
-                nextMeasurementTime = now + SENSOR_CYCLE_TIME;
-                break;
-        }
-        measurementStarted = true;
-        return;
+    measurementStarted = false;
+    frameActive = false;
+    currentSensor = LEFT_SENSOR;
+    nextMeasurementTime = now + SENSOR_CYCLE_TIME;
+    rateWindowFrames = 0;
+    rateWindowStart = now;
+    frameRateHz = 0;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        rateWindowReadings[i] = 0;
+        refreshRateHz[i] = 0;
+    }
+
+    logger.info(String("Ranging mode: ") + (mode == RangingMode::Concurrent ? "concurrent" : "sequential"),
+                LogContext::Sensor);
+}
+
+void DistanceSensors::planFrame() {
+    ScheduleInputs inputs;
+    inputs.speedPercent = hintSpeedPercent;
+    inputs.steering = hintSteering;
+    inputs.frontDistance = lastMeasurements[FRONT_SENSOR];
+    inputs.frontClosingMmS = closingMmS[FRONT_SENSOR];
+    framePlan = schedule->plan(inputs);
+    if (!framePlan.fireSides && !framePlan.fireFront) {
+        framePlan.fireFront = true;  // A frame always reads something
+    }
+
+    framePlanned = 0;
+    if (framePlan.fireSides) framePlanned |= (1 << LEFT_SENSOR) | (1 << RIGHT_SENSOR);
+    if (framePlan.fireFront) framePlanned |= 1 << FRONT_SENSOR;
+
+    // Timeout scales with the range needed, full range is the legacy timeout
+    uint32_t sideTimeout = (uint32_t)SENSOR_READ_TIMEOUT * 1000 * min(framePlan.sideRangeMm, (uint16_t)MAX_SENSOR_DISTANCE) / MAX_SENSOR_DISTANCE;
+    uint32_t frontTimeout = (uint32_t)SENSOR_READ_TIMEOUT * 1000 * min(framePlan.frontRangeMm, (uint16_t)MAX_SENSOR_DISTANCE) / MAX_SENSOR_DISTANCE;
+    frameTimeoutUs[LEFT_SENSOR] = sideTimeout;
+    frameTimeoutUs[RIGHT_SENSOR] = sideTimeout;
+    frameTimeoutUs[FRONT_SENSOR] = frontTimeout;
+
+    frameActive = true;
+    frameTriggered = 0;
+    frameFinished = 0;
+}
+
+int DistanceSensors::nextPlanned(int from) const {
+    for (int i = from; i < NUM_SENSORS; i++) {
+        if (framePlanned & (1 << i)) return i;
+    }
+    return NUM_SENSORS;
+}
+
+void DistanceSensors::startSensor(SensorIndex sensor) {
+    triggerUs[sensor] = micros();
+    frameTriggered |= 1 << sensor;
+
+    switch(sensor) {
+        case LEFT_SENSOR:
+            leftSensor.startAsync(frameTimeoutUs[LEFT_SENSOR]);
+            break;
+        case RIGHT_SENSOR:
+            rightSensor.startAsync(frameTimeoutUs[RIGHT_SENSOR]);
+            break;
+        case FRONT_SENSOR:
+            frontSensor.startAsync(frameTimeoutUs[FRONT_SENSOR]);
+            break;
     }
+}
 
+bool DistanceSensors::pollSensor(SensorIndex sensor, uint16_t& distance) {
     bool sensorFinished = false;
-    uint16_t distance = 0;
 
-    switch(currentSensor) {
+    switch(sensor) {
         case LEFT_SENSOR:
             sensorFinished = leftSensor.isFinished();
             if (sensorFinished) distance = leftSensor.getDist_mm();
+#if SENSOR_BACKEND_MCPWM
+            if (sensorFinished) captureLatencyUs[LEFT_SENSOR] = leftSensor.getCaptureLatencyUs();
+#endif
             break;
         case RIGHT_SENSOR:
             sensorFinished = rightSensor.isFinished();
             if (sensorFinished) distance = rightSensor.getDist_mm();
+#if SENSOR_BACKEND_MCPWM
+            if (sensorFinished) captureLatencyUs[RIGHT_SENSOR] = rightSensor.getCaptureLatencyUs();
+#endif
             break;
         case FRONT_SENSOR:
             sensorFinished = frontSensor.isFinished();
             if (sensorFinished) distance = frontSensor.getDist_mm();
+#if SENSOR_BACKEND_MCPWM
+            if (sensorFinished) captureLatencyUs[FRONT_SENSOR] = frontSensor.getCaptureLatencyUs();
+#endif
             break;
     }
+    if (sensorFinished) {
+        readingCount[sensor]++;
+        rateWindowReadings[sensor]++;
+    }
+    return sensorFinished;
+}
+
+void DistanceSensors::storeMeasurement(SensorIndex sensor, uint16_t distance, unsigned long now) {
+    if (distance == 0) {
+        const char* sensorNames[] = {"Left", "Right", "Front"};
+        logger.debug(String(sensorNames[sensor]) + " sensor - No echo", LogContext::Sensor);
+        rawMeasurements[sensor] = MAX_SENSOR_DISTANCE;
+    } else {
+        rawMeasurements[sensor] = min(distance, (uint16_t)MAX_SENSOR_DISTANCE);
+    }
+    uint16_t previous = lastMeasurements[sensor];
+    unsigned long previousTime = lastReadTime[sensor];
+    bool accepted = filters[sensor].update(distance, now);
+    lastMeasurements[sensor] = filters[sensor].getDistance();
+    lastReadTime[sensor] = now;
+
+    // Readings the filter took, unmedianed so the ring has no lag of its own.
+    // Stamped at the moment the ping reached the obstacle, half the flight time.
+    if (accepted) {
+        uint16_t sample = distance == 0 ? lastMeasurements[sensor] : rawMeasurements[sensor];
+        samples[sensor].push(triggerUs[sensor] + (uint32_t)sample * 1000 / 343, sample);
+    }
 
-    if (measurementStarted && sensorFinished) {
-        if (distance == 0) {
-            const char* sensorNames[] = {"Front", "Left", "Right"};
-            logger.debug(String(sensorNames[currentSensor]) + " sensor - No echo", LogContext::Sensor);
-            lastMeasurements[currentSensor] = MAX_SENSOR_DISTANCE;
+    // Closing rate from consecutive filtered readings. Going to or from no
+    // echo isn't motion, the obstacle only came into or left the range.
+    if (previousTime > 0 && now > previousTime) {
+        if (previous >= MAX_SENSOR_DISTANCE || lastMeasurements[sensor] >= MAX_SENSOR_DISTANCE) {
+            closingMmS[sensor] = 0;
         } else {
-            lastMeasurements[currentSensor] = min(distance, (uint16_t)MAX_SENSOR_DISTANCE);
+            float closing = ((float)previous - lastMeasurements[sensor]) * 1000.0f / (now - previousTime);
+            closingMmS[sensor] += SENSOR_CLOSING_SMOOTHING * (closing - closingMmS[sensor]);
         }
-        
-        lastReadTime[currentSensor] = now;
+    }
+}
+
+uint16_t DistanceSensors::predictDistance(int sensor, uint32_t nowUs) const {
+    const SampleRing<SENSOR_SAMPLE_RING>& ring = samples[sensor];
+    if (ring.size() == 0) {
+        return lastMeasurements[sensor];
+    }
+    uint16_t newest = ring[0].distance;
+    if (newest >= MAX_SENSOR_DISTANCE) {
+        return MAX_SENSOR_DISTANCE;  // Nothing in range to track
+    }
+
+    // Not driving forward (stopped, or a backup with the speed at 0): a slope
+    // from before the stop would only extrapolate motion that has ended
+    float rate = 0;  // mm/s, negative when closing in
+    if (hintSpeedPercent > 0) ring.fitSlope(SENSOR_PREDICT_WINDOW_MS * 1000UL, MAX_SENSOR_DISTANCE, 3, SENSOR_PREDICT_MAX_RESIDUAL, rate);
+
+    // Straight ahead, driving forward closes the gap at the forward speed.
+    // Side readings follow walls at an angle, they only get the fitted slope.
+    if (sensor == FRONT_SENSOR && hasVelocityHint) {
+        rate = SENSOR_PREDICT_ODOMETRY_WEIGHT * -forwardVelocityMmS +
+               (1.0f - SENSOR_PREDICT_ODOMETRY_WEIGHT) * rate;
+    }
+
+    uint32_t ageUs = min(nowUs - ring[0].timeUs, (uint32_t)SENSOR_PREDICT_MAX_AGE_MS * 1000);
+    float predicted = newest + rate * ageUs / 1000000.0f;
+    return constrain((long)lroundf(predicted), 0L, (long)MAX_SENSOR_DISTANCE);
+}
+
+uint32_t DistanceSensors::getOutlierRejections() const {
+    uint32_t total = 0;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        total += filters[i].getRejected();
+    }
+    return total;
+}
+
+void DistanceSensors::countFrame(unsigned long now) {
+    frameCount++;
+    rateWindowFrames++;
+
+    unsigned long elapsed = now - rateWindowStart;
+    if (elapsed >= 1000) {
+        frameRateHz = rateWindowFrames * 1000.0f / elapsed;
+        rateWindowFrames = 0;
+        for (int i = 0; i < NUM_SENSORS; i++) {
+            refreshRateHz[i] = rateWindowReadings[i] * 1000.0f / elapsed;
+            rateWindowReadings[i] = 0;
+        }
+        rateWindowStart = now;
+    }
+}
+
+void DistanceSensors::updateSequential() {
+    unsigned long now = millis();
+    
+    if (!measurementStarted && now >= nextMeasurementTime) {
+        if (!frameActive) {
+            planFrame();
+            currentSensor = static_cast<SensorIndex>(nextPlanned(LEFT_SENSOR));
+        }
+        startSensor(currentSensor);
+        nextMeasurementTime = now + SENSOR_CYCLE_TIME;  // Wait full cycle before next sensor
+        measurementStarted = true;
+        return;
+    }
+
+    uint16_t distance = 0;
+    if (measurementStarted && pollSensor(currentSensor, distance)) {
+        storeMeasurement(currentSensor, distance, now);
         measurementStarted = false;
         measurementUpdated = true;  // Set flag as soon as any sensor is updated
         
-        // Move to next sensor with proper casting
-        currentSensor = static_cast<SensorIndex>((static_cast<int>(currentSensor) + 1) % NUM_SENSORS);
+        // Move to the next sensor in this frame's plan
+        int next = nextPlanned(currentSensor + 1);
         
-        // Set delay only if we're not done with all sensors
-        if (currentSensor != 0) {
+        // Set delay only if we're not done with the frame
+        if (next < NUM_SENSORS) {
+            currentSensor = static_cast<SensorIndex>(next);
             nextMeasurementTime = now + MEASUREMENT_SPACING;
         } else {
+            currentSensor = LEFT_SENSOR;
+            frameActive = false;
             nextMeasurementTime = now;
+            countFrame(now);
+        }
+    }
+}
+
+// A stray echo from another sensor's ping shows up on this sensor's clock at
+// that sensor's own reading, shifted by the trigger offset between the two.
+// When the other sensor timed out, only the earliest possible arrival is known.
+// A reading that lands in that window AND jumps away from what this sensor has
+// been seeing is dropped. The front stagger alternates between frames, so a
+// stray echo moves while a real one doesn't: the same jump seen again next
+// frame is a real change and goes through.
+bool DistanceSensors::isCrosstalk(SensorIndex sensor) const {
+    int32_t reading = frameDistance[sensor];
+    if (reading == 0 || lastReadTime[sensor] == 0) return false;
+    if (abs(reading - (int32_t)lastMeasurements[sensor]) <= CROSSTALK_MAX_JUMP_MM) return false;
+    if (suspectDistance[sensor] != 0 &&
+        abs(reading - (int32_t)suspectDistance[sensor]) <= CROSSTALK_WINDOW_MM) {
+        return false;
+    }
+
+    for (int other = 0; other < NUM_SENSORS; other++) {
+        if (other == sensor || !(frameTriggered & (1 << other))) continue;
+        int32_t offsetMm = (int32_t)(triggerUs[sensor] - triggerUs[other]) * 343 / 2000;
+        if (frameDistance[other] == 0) {
+            // Other echo came back after its timeout, so it can land anywhere past that
+            int32_t earliest = (int32_t)frameTimeoutUs[other] * 343 / 2000 - offsetMm;
+            if (reading >= earliest - CROSSTALK_WINDOW_MM) {
+                return true;
+            }
+            continue;
+        }
+        int32_t arrival = (int32_t)frameDistance[other] - offsetMm;
+        if (abs(reading - arrival) <= CROSSTALK_WINDOW_MM) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DistanceSensors::updateConcurrent() {
+    unsigned long now = millis();
+
+    if (!frameActive) {
+        if (now < nextMeasurementTime) return;
+        planFrame();
+        frameStartUs = micros();
+        if (framePlan.fireSides) {
+            // Stagger only alternates on frames that fire all three, see isCrosstalk()
+            if (framePlan.fireFront) {
+                frameStaggerUs = frameStaggerUs == SENSOR_STAGGER_US
+                    ? SENSOR_STAGGER_US + SENSOR_STAGGER_JITTER_US
+                    : SENSOR_STAGGER_US;
+            }
+            // Side sensors point away from each other, fire them together
+            startSensor(LEFT_SENSOR);
+            startSensor(RIGHT_SENSOR);
+        } else {
+            startSensor(FRONT_SENSOR);
+        }
+        return;
+    }
+
+    if (framePlan.fireFront && !(frameTriggered & (1 << FRONT_SENSOR)) &&
+        micros() - frameStartUs >= frameStaggerUs) {
+        startSensor(FRONT_SENSOR);
+    }
+
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        uint8_t bit = 1 << i;
+        if (!(frameTriggered & bit) || (frameFinished & bit)) continue;
+        uint16_t distance = 0;
+        if (pollSensor(static_cast<SensorIndex>(i), distance)) {
+            frameDistance[i] = distance;
+            frameFinished |= bit;
+        }
+    }
+
+    if (frameFinished != framePlanned) return;
+
+    // Judge the whole frame before storing anything, the check compares
+    // against each sensor's previous value
+    bool rejected[NUM_SENSORS];
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        rejected[i] = (framePlanned & (1 << i)) && isCrosstalk(static_cast<SensorIndex>(i));
+    }
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        if (!(framePlanned & (1 << i))) continue;
+        if (rejected[i]) {
+            suspectDistance[i] = frameDistance[i];
+            crosstalkRejections++;
+            continue;
+        }
+        suspectDistance[i] = 0;
+        storeMeasurement(static_cast<SensorIndex>(i), frameDistance[i], now);
+    }
+
+    frameActive = false;
+    measurementUpdated = true;
+    nextMeasurementTime = now + SENSOR_FRAME_GAP;
+
+    // A shortened timeout doesn't stop an echo from further out, give it the
+    // full range time to come back before the next trigger
+    unsigned long nowUs = micros();
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        if (!(framePlanned & (1 << i)) || frameTimeoutUs[i] >= SENSOR_READ_TIMEOUT * 1000UL) continue;
+        long waitUs = (long)(triggerUs[i] + SENSOR_READ_TIMEOUT * 1000UL - nowUs);
+        if (waitUs > 0) {
+            nextMeasurementTime = max(nextMeasurementTime, now + (waitUs + 999) / 1000);
         }
     }
+    countFrame(now);
 }
@@ -1,8 +1,15 @@
 #pragma once
 #include <Arduino.h>
-#include "HC_SR04.h"
 #include "config.h"
 #include "Logger.h"
+#include "sensors/RangeFilter.h"
+#include "sensors/SchedulePolicy.h"
+#include "sensors/SampleRing.h"
+#if SENSOR_BACKEND_MCPWM
+#include "sensors/McpwmEchoSensor.h"
+#else
+#include "HC_SR04.h"
+#endif
 
 enum SensorIndex {
     LEFT_SENSOR = 0,
@@ -10,28 +17,93 @@ enum SensorIndex {
     FRONT_SENSOR = 2
 };
 
+enum class RangingMode {
+    Sequential,  // One sensor at a time, round-robin
+    Concurrent   // Side pair together, front staggered, one frame = all three
+};
+
 class DistanceSensors {
 private:
     Logger& logger;
-    uint16_t lastMeasurements[NUM_SENSORS];
+    uint16_t lastMeasurements[NUM_SENSORS];      // Filtered
+    uint16_t rawMeasurements[NUM_SENSORS] = {0}; // As read, no echo = MAX_SENSOR_DISTANCE
+    RangeFilter filters[NUM_SENSORS];
+    SampleRing<SENSOR_SAMPLE_RING> samples[NUM_SENSORS];  // Accepted readings, stamped at the echo
+    float forwardVelocityMmS = 0;
+    bool hasVelocityHint = false;
     unsigned long lastReadTime[NUM_SENSORS];
+    uint32_t captureLatencyUs[NUM_SENSORS] = {0};
     SensorIndex currentSensor = LEFT_SENSOR;  // Changed from uint8_t to SensorIndex
     
+#if SENSOR_BACKEND_MCPWM
+    McpwmEchoSensor frontSensor;
+    McpwmEchoSensor leftSensor;
+    McpwmEchoSensor rightSensor;
+#else
     HC_SR04<FRONT_ECHO_PIN> frontSensor;
     HC_SR04<LEFT_ECHO_PIN> leftSensor;
     HC_SR04<RIGHT_ECHO_PIN> rightSensor;
+#endif
     
     bool measurementStarted = false;
     unsigned long nextMeasurementTime = 0;
     static constexpr unsigned long MEASUREMENT_SPACING = SENSOR_CYCLE_TIME;  // ms between measurements
     bool measurementUpdated = false;
 
+    // Frame scheduling
+    EqualSchedule equalSchedule;
+    AdaptiveSchedule adaptiveSchedule;
+    SchedulePolicy* schedule = SCHED_ADAPTIVE ? static_cast<SchedulePolicy*>(&adaptiveSchedule) : &equalSchedule;
+    float hintSpeedPercent = 0;
+    float hintSteering = 0;
+    float closingMmS[NUM_SENSORS] = {0};    // Smoothed, > 0 when the gap shrinks
+    SensorPlan framePlan;
+    uint8_t framePlanned = 0;               // Bitmask by SensorIndex
+    uint32_t frameTimeoutUs[NUM_SENSORS] = {0};
+
+    // Frame state
+    RangingMode rangingMode = SENSOR_RANGING_CONCURRENT ? RangingMode::Concurrent : RangingMode::Sequential;
+    bool frameActive = false;
+    uint8_t frameTriggered = 0;             // Bitmask by SensorIndex
+    uint8_t frameFinished = 0;
+    unsigned long frameStartUs = 0;
+    unsigned long frameStaggerUs = SENSOR_STAGGER_US;
+    unsigned long triggerUs[NUM_SENSORS] = {0};
+    uint16_t frameDistance[NUM_SENSORS] = {0};     // Raw reading, 0 = no echo
+    uint16_t suspectDistance[NUM_SENSORS] = {0};   // Last rejected reading, 0 = none
+
+    // Measurement stats
+    uint32_t frameCount = 0;
+    uint32_t crosstalkRejections = 0;
+    uint32_t rateWindowFrames = 0;
+    uint32_t readingCount[NUM_SENSORS] = {0};
+    uint32_t rateWindowReadings[NUM_SENSORS] = {0};
+    unsigned long rateWindowStart = 0;
+    float frameRateHz = 0;
+    float refreshRateHz[NUM_SENSORS] = {0};
+
+    void planFrame();
+    int nextPlanned(int from) const;  // NUM_SENSORS when none left
+    void startSensor(SensorIndex sensor);
+    bool pollSensor(SensorIndex sensor, uint16_t& distance);
+    void storeMeasurement(SensorIndex sensor, uint16_t distance, unsigned long now);
+    bool isCrosstalk(SensorIndex sensor) const;
+    void countFrame(unsigned long now);
+    void updateSequential();
+    void updateConcurrent();
+
 public:
     DistanceSensors(Logger& l) 
         : logger(l),
+#if SENSOR_BACKEND_MCPWM
+          frontSensor(FRONT_TRIG_PIN, FRONT_ECHO_PIN, MCPWM_SELECT_CAP0),
+          leftSensor(LEFT_TRIG_PIN, LEFT_ECHO_PIN, MCPWM_SELECT_CAP1),
+          rightSensor(RIGHT_TRIG_PIN, RIGHT_ECHO_PIN, MCPWM_SELECT_CAP2) {
+#else
           frontSensor(FRONT_TRIG_PIN),
           leftSensor(LEFT_TRIG_PIN),
           rightSensor(RIGHT_TRIG_PIN) {
+#endif
         
         for(int i = 0; i < NUM_SENSORS; i++) {
             lastMeasurements[i] = 0;
@@ -48,6 +120,32 @@ public:
     uint16_t getLeftDistance() const { return lastMeasurements[LEFT_SENSOR]; }
     uint16_t getRightDistance() const { return lastMeasurements[RIGHT_SENSOR]; }
     unsigned long getLastReadTime(int sensor) const { return lastReadTime[sensor]; }
+    uint32_t getCaptureLatencyUs(int sensor) const { return captureLatencyUs[sensor]; }  // 0 without MCPWM backend
+    uint16_t getRawDistance(int sensor) const { return rawMeasurements[sensor]; }
+    float getConfidence(int sensor) const { return filters[sensor].getConfidence(); }
+    unsigned long getAge(int sensor) const { return filters[sensor].getAge(millis()); }  // ms since last accepted reading
+    uint32_t getOutlierRejections() const;
+
+    // Where each obstacle is at nowUs (micros()), extrapolated from the sample
+    // ring. Readings within a frame are taken ms apart and navigation runs a
+    // while after the echo, this lines them up on the same instant.
+    uint16_t predictDistance(int sensor, uint32_t nowUs) const;
+    void setOdometryHint(float forwardMmS) { forwardVelocityMmS = forwardMmS; hasVelocityHint = true; }
     bool hasNewMeasurements() const { return measurementUpdated; }
     void clearNewMeasurementsFlag() { measurementUpdated = false; }
+
+    void setRangingMode(RangingMode mode);
+    RangingMode getRangingMode() const { return rangingMode; }
+    float getFrameRateHz() const { return frameRateHz; }  // Full three-sensor frames, updated once a second
+    uint32_t getFrameCount() const { return frameCount; }
+    uint32_t getCrosstalkRejections() const { return crosstalkRejections; }
+
+    // Scheduling, the hint is what the motors are doing right now
+    void setMotionHint(float speedPercent, float steering) { hintSpeedPercent = speedPercent; hintSteering = steering; }
+    void setSchedulePolicy(SchedulePolicy& policy) { schedule = &policy; }
+    const char* getScheduleName() const { return schedule->name(); }
+    float getRefreshRateHz(int sensor) const { return refreshRateHz[sensor]; }  // Readings per second
+    uint32_t getReadingCount(int sensor) const { return readingCount[sensor]; }
+    float getClosingMmS(int sensor) const { return closingMmS[sensor]; }
+    float getFrontClosingMmS() const { return closingMmS[FRONT_SENSOR]; }
 };
@@ -1,14 +1,117 @@
 #include "Motor.h"
+#include <esp_timer.h>
 
 // Update constructor
 Motor::Motor(int pin1, int pin2, int encPin, Logger& log)
     : in1Pin(pin1), in2Pin(pin2), encoderPin(encPin), logger(log) {
 }
 
+#if MOTOR_PWM_BACKEND_LEDC
+static_assert((uint64_t)MOTOR_PWM_FREQUENCY << MOTOR_PWM_RESOLUTION <= 80000000,
+              "PWM frequency too high for this resolution");
+uint8_t Motor::nextLedcChannel = LEDC_CHANNEL_0;
+#endif
+
+#if ENCODER_BACKEND_PCNT
+uint8_t Motor::nextPcntUnit = PCNT_UNIT_0;
+
+void IRAM_ATTR Motor::pcntOverflowISR(void* arg) {
+    // Counter has already reset to 0 in hardware
+    Motor* motor = static_cast<Motor*>(arg);
+    motor->pcntWrappedEdges += PCNT_LIMIT;
+}
+
+uint32_t Motor::readEdges() const {
+    // Re-read if the counter wrapped between the two reads
+    uint32_t wrapped;
+    int16_t count;
+    do {
+        wrapped = pcntWrappedEdges;
+        pcnt_get_counter_value(pcntUnit, &count);
+    } while (wrapped != pcntWrappedEdges);
+    uint32_t total = wrapped + count;
+    // The counter resets at PCNT_LIMIT before the ISR gets to add the wrap, a
+    // read in between comes out one wrap short
+    if ((int32_t)(total - lastReadEdges) < 0) {
+        total += PCNT_LIMIT;
+    }
+    lastReadEdges = total;
+    return total;
+}
+
+uint32_t Motor::takePulses() {
+    uint32_t total = readEdges();
+    uint32_t pulses = total - speedBaseEdges;
+    speedBaseEdges = total;
+    return pulses;
+}
+
+void Motor::watchEdges() {
+    uint32_t total = readEdges();
+    if (total != watchedEdges) {
+        watchedEdges = total;
+        lastPulseTime = millis();
+        // Timed to the control tick, count method takes over before that matters
+        recordEdges(total, (uint32_t)esp_timer_get_time());
+    }
+}
+#else
 void IRAM_ATTR Motor::encoderISR(void* arg) {
     Motor* motor = static_cast<Motor*>(arg);
     motor->accumulatedPulses++;
     motor->lastPulseTime = millis();
+    motor->recordEdges(motor->edgeHistoryCount + 1, (uint32_t)esp_timer_get_time());
+}
+
+uint32_t Motor::takePulses() {
+    uint32_t pulses = accumulatedPulses;
+    accumulatedPulses = 0;
+    return pulses;
+}
+#endif
+
+void IRAM_ATTR Motor::recordEdges(uint32_t total, uint32_t timeUs) {
+    size_t slot = edgeHistoryCount % EDGE_HISTORY;
+    edgeTotals[slot] = total;
+    edgeTimesUs[slot] = timeUs;
+    edgeHistoryCount = edgeHistoryCount + 1;  // Last, readers check it for torn copies
+}
+
+float Motor::periodEdgeRate(uint32_t nowUs) const {
+    uint32_t totals[EDGE_HISTORY];
+    uint32_t times[EDGE_HISTORY];
+    uint32_t count;
+    // Copy again if an edge came in meanwhile
+    do {
+        count = edgeHistoryCount;
+        for (size_t i = 0; i < EDGE_HISTORY; i++) {
+            totals[i] = edgeTotals[i];
+            times[i] = edgeTimesUs[i];
+        }
+    } while (count != edgeHistoryCount);
+
+    if (count < 2) return -1.0f;
+
+    // Walk back from the newest entry until the span covers enough edges
+    size_t newest = (count - 1) % EDGE_HISTORY;
+    size_t available = count < EDGE_HISTORY ? count : EDGE_HISTORY;
+    size_t oldest = newest;
+    for (size_t back = 1; back < available; back++) {
+        oldest = (count - 1 - back) % EDGE_HISTORY;
+        if (totals[newest] - totals[oldest] >= VELOCITY_PERIOD_EDGES) break;
+    }
+
+    uint32_t edges = totals[newest] - totals[oldest];
+    uint32_t spanUs = times[newest] - times[oldest];
+    if (edges == 0 || spanUs == 0) return -1.0f;
+    float rate = edges * 1000000.0f / spanUs;
+
+    // No edge since the newest one, so the wheel can't be faster than that
+    uint32_t sinceUs = nowUs - times[newest];
+    if (sinceUs > 0) {
+        rate = min(rate, 1000000.0f / sinceUs);
+    }
+    return rate;
 }
 
 void Motor::begin() {
@@ -16,12 +119,84 @@ void Motor::begin() {
     pinMode(in2Pin, OUTPUT);
     pinMode(encoderPin, INPUT_PULLUP);
     
+#if MOTOR_PWM_BACKEND_LEDC
+    if (nextLedcChannel + 2 > LEDC_CHANNEL_MAX) {
+        logger.error("No LEDC channels left for motor", LogContext::Motor);
+        return;
+    }
+    if (nextLedcChannel == LEDC_CHANNEL_0) {
+        ledc_timer_config_t timer = {};
+        timer.speed_mode = LEDC_MODE;
+        timer.duty_resolution = static_cast<ledc_timer_bit_t>(MOTOR_PWM_RESOLUTION);
+        timer.timer_num = LEDC_TIMER_0;
+        timer.freq_hz = MOTOR_PWM_FREQUENCY;
+        timer.clk_cfg = LEDC_AUTO_CLK;
+        if (ledc_timer_config(&timer) != ESP_OK) {
+            logger.error("Failed to configure motor PWM timer", LogContext::Motor);
+        }
+    }
+    channel1 = static_cast<ledc_channel_t>(nextLedcChannel++);
+    channel2 = static_cast<ledc_channel_t>(nextLedcChannel++);
+
+    // Outputs start at zero duty
+    const int pins[2] = {in1Pin, in2Pin};
+    const ledc_channel_t channels[2] = {channel1, channel2};
+    for (int i = 0; i < 2; i++) {
+        ledc_channel_config_t config = {};
+        config.gpio_num = pins[i];
+        config.speed_mode = LEDC_MODE;
+        config.channel = channels[i];
+        config.intr_type = LEDC_INTR_DISABLE;
+        config.timer_sel = LEDC_TIMER_0;
+        config.duty = 0;
+        config.hpoint = 0;
+        ledc_channel_config(&config);
+    }
+#else
     // Initialize outputs to zero
     analogWrite(in1Pin, 0);
     analogWrite(in2Pin, 0);
     
     analogWriteResolution(MOTOR_PWM_RESOLUTION);
+#endif
     
+#if ENCODER_BACKEND_PCNT
+    if (nextPcntUnit >= PCNT_UNIT_MAX) {
+        logger.error("No PCNT unit left for encoder", LogContext::Motor);
+        return;
+    }
+    pcntUnit = static_cast<pcnt_unit_t>(nextPcntUnit++);
+
+    // Both edges, same as the CHANGE interrupt, so speeds keep their scale
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = encoderPin;
+    config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_INC;
+    config.counter_h_lim = PCNT_LIMIT;
+    config.counter_l_lim = -PCNT_LIMIT;
+    config.unit = pcntUnit;
+    config.channel = PCNT_CHANNEL_0;
+    pcnt_unit_config(&config);
+
+    pcnt_set_filter_value(pcntUnit, ENCODER_GLITCH_FILTER);
+    pcnt_filter_enable(pcntUnit);
+
+    pcnt_event_enable(pcntUnit, PCNT_EVT_H_LIM);
+    // Shared by both motors, already installed is fine
+    esp_err_t err = pcnt_isr_service_install(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        logger.error("Failed to install PCNT ISR service", LogContext::Motor);
+    }
+    pcnt_isr_handler_add(pcntUnit, pcntOverflowISR, this);
+
+    pcnt_counter_pause(pcntUnit);
+    pcnt_counter_clear(pcntUnit);
+    pcnt_counter_resume(pcntUnit);
+    lastPulseTime = millis();
+#else
     // Setup encoder interrupt
     attachInterruptArg(
         digitalPinToInterrupt(encoderPin),
@@ -29,15 +204,20 @@ void Motor::begin() {
         this,
         CHANGE
     );
+#endif
 }
 
-float Motor::getCurrentSpeed() {
+void Motor::update() {
+#if ENCODER_BACKEND_PCNT
+    watchEdges();  // The ISR keeps lastPulseTime and the edge history itself
+#endif
+
     unsigned long now = millis();
     unsigned long timeSinceLastUpdate = now - lastSpeedUpdate;
     
     if (timeSinceLastUpdate >= MOTOR_UPDATE_INTERVAL) {
         // Calculate instantaneous speed
-        float instantSpeed = (float)accumulatedPulses * (MOTOR_UPDATE_INTERVAL / (float)timeSinceLastUpdate);
+        float instantSpeed = (float)takePulses() * (MOTOR_UPDATE_INTERVAL / (float)timeSinceLastUpdate);
         
         // Update circular buffer
         speedBuffer[speedBufferIndex] = instantSpeed;
@@ -50,26 +230,74 @@ float Motor::getCurrentSpeed() {
         }
         currentSpeed = sum / SPEED_BUFFER_SIZE;
         
-        // Reset pulse counter
-        accumulatedPulses = 0;
         lastSpeedUpdate = now;
     }
-    
-    return currentSpeed;
+}
+
+float Motor::getVelocityMmS() const {
+    float countMmS = currentSpeed * (1000.0f / MOTOR_UPDATE_INTERVAL) / ENCODER_EDGES_PER_MM;
+    float periodRate = periodEdgeRate((uint32_t)esp_timer_get_time());
+    if (periodRate < 0) return countMmS;
+
+    // Counts quantise badly at low speed, periods get noisy at high speed
+    float periodMmS = periodRate / ENCODER_EDGES_PER_MM;
+    float weight = constrain((countMmS - VELOCITY_BLEND_LOW_MM_S) /
+                             (VELOCITY_BLEND_HIGH_MM_S - VELOCITY_BLEND_LOW_MM_S), 0.0f, 1.0f);
+    return periodMmS + (countMmS - periodMmS) * weight;
 }
 
 void Motor::setPwm(int pwm) {
+    if (stagePwm(pwm)) {
+        commitPwm();
+    }
+}
+
+bool Motor::stagePwm(int pwm) {
     const int maxPwm = (1 << MOTOR_PWM_RESOLUTION) - 1;
     pwm = constrain(pwm, -maxPwm, maxPwm);
+
+    if (pwm == currentPwm) {
+        pwmSkipped++;
+        return false;
+    }
+    // Stopping and reversing always go through, small trims are rate limited
+    unsigned long now = millis();
+    bool sameDirection = (pwm > 0 && currentPwm > 0) || (pwm < 0 && currentPwm < 0);
+    if (sameDirection && (abs(pwm - currentPwm) < MOTOR_PWM_MIN_CHANGE ||
+                          now - lastPwmWrite < MOTOR_PWM_MIN_UPDATE_INTERVAL)) {
+        pwmSkipped++;
+        return false;
+    }
     currentPwm = pwm;
-        
-    if (pwm >= 0) {
-        analogWrite(in2Pin, 0);
-        analogWrite(in1Pin, pwm);
-    } else {
+    lastPwmWrite = now;
+
+    uint32_t duty1 = pwm >= 0 ? pwm : 0;
+    uint32_t duty2 = pwm < 0 ? -pwm : 0;
+#if MOTOR_PWM_BACKEND_LEDC
+    // Only lands in the duty registers, commitPwm() makes it take effect
+    ledc_set_duty(LEDC_MODE, channel1, duty1);
+    ledc_set_duty(LEDC_MODE, channel2, duty2);
+#else
+    pendingDuty1 = duty1;
+    pendingDuty2 = duty2;
+#endif
+    return true;
+}
+
+void Motor::commitPwm() {
+#if MOTOR_PWM_BACKEND_LEDC
+    ledc_update_duty(LEDC_MODE, channel1);
+    ledc_update_duty(LEDC_MODE, channel2);
+#else
+    // Off side first so both inputs are never driven together
+    if (pendingDuty1 == 0) {
         analogWrite(in1Pin, 0);
-        analogWrite(in2Pin, -pwm);
+        analogWrite(in2Pin, pendingDuty2);
+    } else {
+        analogWrite(in2Pin, 0);
+        analogWrite(in1Pin, pendingDuty1);
     }
+#endif
 }
 
 void Motor::stop() {
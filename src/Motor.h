@@ -2,6 +2,12 @@
 #include <Arduino.h>
 #include "config.h"
 #include "Logger.h"
+#if ENCODER_BACKEND_PCNT
+#include <driver/pcnt.h>
+#endif
+#if MOTOR_PWM_BACKEND_LEDC
+#include <driver/ledc.h>
+#endif
 
 class Motor {
 private:
@@ -10,14 +16,56 @@ private:
     const int encoderPin;
     Logger& logger;
     
-    volatile uint32_t accumulatedPulses = 0;  // Total pulses since last read
     volatile unsigned long lastPulseTime = 0;
     unsigned long lastSpeedUpdate = 0;
     float currentSpeed = 0.0f;         // Store last calculated speed
     int16_t currentPwm = 0;
+    unsigned long lastPwmWrite = 0;
+    uint32_t pwmSkipped = 0;           // Writes dropped as unchanged or too small
+
+#if MOTOR_PWM_BACKEND_LEDC
+    // One channel per H-bridge input, all motors on one timer so periods line up
+    static constexpr ledc_mode_t LEDC_MODE = LEDC_HIGH_SPEED_MODE;
+    static uint8_t nextLedcChannel;
+    ledc_channel_t channel1 = LEDC_CHANNEL_0;
+    ledc_channel_t channel2 = LEDC_CHANNEL_1;
+#else
+    uint32_t pendingDuty1 = 0;
+    uint32_t pendingDuty2 = 0;
+#endif
     
+#if ENCODER_BACKEND_PCNT
+    // Edges are counted by the PCNT unit, the only interrupt is the counter
+    // wrapping at PCNT_LIMIT. lastPulseTime is kept by update() watching the count.
+    static constexpr int16_t PCNT_LIMIT = 30000;
+    static uint8_t nextPcntUnit;
+    pcnt_unit_t pcntUnit = PCNT_UNIT_0;
+    volatile uint32_t pcntWrappedEdges = 0;
+    uint32_t speedBaseEdges = 0;       // Total at the last speed window
+    uint32_t watchedEdges = 0;         // Total at the last update()
+    mutable uint32_t lastReadEdges = 0;  // Keeps readEdges() monotonic across a pending wrap
+
+    static void IRAM_ATTR pcntOverflowISR(void* arg);
+    uint32_t readEdges() const;        // Total edges since begin()
+    void watchEdges();
+#else
+    volatile uint32_t accumulatedPulses = 0;  // Total pulses since last read
+
     // Remove hardcoded PWM_RESOLUTION
     static void IRAM_ATTR encoderISR(void* arg);
+#endif
+    uint32_t takePulses();             // Pulses since the last call
+
+    // Edge totals and esp_timer times of the last few edges (ISR) or count
+    // changes seen by update() (PCNT), for the period based velocity
+    static constexpr size_t EDGE_HISTORY = 8;
+    static_assert(VELOCITY_PERIOD_EDGES < EDGE_HISTORY, "Period span needs more edge history");
+    volatile uint32_t edgeTotals[EDGE_HISTORY] = {0};
+    volatile uint32_t edgeTimesUs[EDGE_HISTORY] = {0};
+    volatile uint32_t edgeHistoryCount = 0;  // Entries ever written
+
+    void IRAM_ATTR recordEdges(uint32_t total, uint32_t timeUs);
+    float periodEdgeRate(uint32_t nowUs) const;  // Edges per second, -1 if unknown
     
     static constexpr size_t SPEED_BUFFER_SIZE = 4;  // Number of samples to average
     float speedBuffer[SPEED_BUFFER_SIZE] = {0};
@@ -26,11 +74,24 @@ private:
 public:
     Motor(int pin1, int pin2, int encPin, Logger& log);
     void begin();
-    void setPwm(int pwm);  // -PWM_MAX to PWM_MAX (based on MOTOR_PWM_RESOLUTION)
+    void update();  // Once per control tick, advances the speed window
+    void setPwm(int pwm);  // -PWM_MAX to PWM_MAX (based on MOTOR_PWM_RESOLUTION), stage and commit
     void stop();
+
+    // Two-step write so MotorController can switch both motors in the same PWM period
+    bool stagePwm(int pwm);  // false when there is nothing worth writing
+    void commitPwm();        // Latch the staged duty, takes effect at the next period
     
-    float getCurrentSpeed();  // Returns pulses per interval
+    float getCurrentSpeed() const { return currentSpeed; }  // Pulses per MOTOR_UPDATE_INTERVAL
+    float getVelocityMmS() const;  // Wheel speed in mm/s, unsigned
+#if ENCODER_BACKEND_PCNT
+    uint32_t getPulseCount() const { return readEdges() - speedBaseEdges; }  // For diagnostics only
+    uint32_t getEdgeCount() const { return readEdges(); }
+#else
     uint32_t getPulseCount() const { return accumulatedPulses; }  // For diagnostics only
+    uint32_t getEdgeCount() const { return edgeHistoryCount; }  // One history entry per edge
+#endif
     unsigned long getTimeSinceLastPulse() const { return millis() - lastPulseTime; }
     int16_t getCurrentPwm() const { return currentPwm; }
+    uint32_t getPwmSkipped() const { return pwmSkipped; }
 };
@@ -8,104 +8,243 @@ void MotorController::begin() {
     
     leftMotor.begin();
     rightMotor.begin();
+    setSlewProfile(slewProfile);
+
+    CalibrationStore::Calibration calibration;
+    if (calibrationStore.load(calibration)) {
+        leftMotorScale = calibration.leftScale;
+        rightMotorScale = calibration.rightScale;
+        leftCurve = calibration.leftCurve;
+        rightCurve = calibration.rightCurve;
+        steeringMixer.setScales(leftMotorScale, rightMotorScale);
+        steeringMixer.setCurves(leftCurve, rightCurve);
+        calibrationStored = true;
+        logger.info("Calibration restored - L:" + String(leftMotorScale) + " R:" + String(rightMotorScale) +
+                    (leftCurve.isValid() && rightCurve.isValid() ? " with speed curves" : ""), LogContext::Motor);
+    }
+}
+
+void MotorController::clearCalibration() {
+    leftMotorScale = DEFAULT_LEFT_MOTOR_SCALE;
+    rightMotorScale = DEFAULT_RIGHT_MOTOR_SCALE;
+    steeringMixer.setScales(leftMotorScale, rightMotorScale);
+    leftCurve.clear();
+    rightCurve.clear();
+    steeringMixer.setCurves(leftCurve, rightCurve);
+    calibrationStore.clear();
+    calibrationStored = false;
+    calibrationStatus = CalibrationStatus::Idle;
+    logger.info("Calibration cleared", LogContext::Motor);
+}
+
+static float percentToPwm(float percent) {
+    return percent / 100.0f * ((1 << MOTOR_PWM_RESOLUTION) - 1);
+}
+
+void MotorController::setDriveMode(DriveMode mode) {
+    if (mode == driveMode) return;
+    driveMode = mode;
+    leftLoop = WheelLoop();
+    rightLoop = WheelLoop();
+    steeringMixer.reset();
+    logger.info(String("Drive mode: ") + (mode == DriveMode::Velocity ? "velocity" : "open loop"),
+                LogContext::Motor);
+}
+
+void MotorController::setSlewProfile(SlewProfile profile) {
+    const float percentToCounts = ((1 << MOTOR_PWM_RESOLUTION) - 1) / 100.0f;
+    slewProfile = profile;
+    switch (profile) {
+        case SlewProfile::Off:
+            leftSlew.setLimits(0, 0);
+            rightSlew.setLimits(0, 0);
+            break;
+        case SlewProfile::Smooth:
+            leftSlew.setLimits(MOTOR_SLEW_SMOOTH_RATE * percentToCounts, MOTOR_SLEW_SMOOTH_JERK * percentToCounts);
+            rightSlew.setLimits(MOTOR_SLEW_SMOOTH_RATE * percentToCounts, MOTOR_SLEW_SMOOTH_JERK * percentToCounts);
+            break;
+        case SlewProfile::Fast:
+            leftSlew.setLimits(MOTOR_SLEW_FAST_RATE * percentToCounts, MOTOR_SLEW_FAST_JERK * percentToCounts);
+            rightSlew.setLimits(MOTOR_SLEW_FAST_RATE * percentToCounts, MOTOR_SLEW_FAST_JERK * percentToCounts);
+            break;
+    }
 }
 
 void MotorController::setSteering(float steering) {
     targetSteeringRatio = constrain(steering, -1.0f, 1.0f);
+    steeringMixer.setTarget(targetSteeringRatio, speedPercent);
 }
 
 void MotorController::setSpeedPercent(float percent) {
     speedPercent = constrain(percent, -100.0f, 100.0f);
+    steeringMixer.setTarget(targetSteeringRatio, speedPercent);
 }
 
-float MotorController::calculateCurrentSteeringRatio() const {
-    float leftSpeed = leftMotor.getCurrentSpeed();
-    float rightSpeed = rightMotor.getCurrentSpeed();
-    
-    // Avoid division by zero and very small values
-    if (abs(leftSpeed) < 2.0f && abs(rightSpeed) < 2.0f) {
-        return 0.0f;
-    }
-
-    // Calculate normalized difference between motors
-    // Positive ratio = turning right (right motor slower)
-    float avgSpeed = (abs(leftSpeed) + abs(rightSpeed)) / 2.0f;
-    if (avgSpeed < 2.0f) return 0.0f;
-    
-    // Adjust ratio calculation based on direction of movement
-    float ratio;
-    if (speedPercent >= 0) {
-        ratio = (leftSpeed - rightSpeed) / (2.0f * avgSpeed);
-    } else {
-        ratio = (rightSpeed - leftSpeed) / (2.0f * avgSpeed);
-    }
-    ratio = constrain(ratio, -1.0f, 1.0f);
-    
-    return ratio;
+void MotorController::advanceSlew() {
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsedUs = lastSlewUs > 0 ? min(now - lastSlewUs, (int64_t)MOTOR_SLEW_MAX_DT_US) : 0;
+    lastSlewUs = now;
+    float dt = elapsedUs / 1000000.0f;
+    // Written every tick, the skip logic in Motor drops the repeats
+    writePwm(lroundf(leftSlew.step(dt)), lroundf(rightSlew.step(dt)));
 }
 
-// Rename updatePID to update for consistency
+// Called every control tick, runs the PID every STEERING_PID_INTERVAL_US
 void MotorController::update() {
-    unsigned long now = millis();
-    if (now - lastPidUpdate < STEERING_PID_INTERVAL) {
+    leftMotor.update();
+    rightMotor.update();
+    advanceSlew();
+
+    // Test and calibration own the motors while they run
+    if (sequenceStep != SequenceStep::Idle) {
+        advanceSequence();
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    int64_t elapsedUs = now - lastPidUpdateUs;
+    // Half a tick of slack so tick jitter doesn't push the PID to the next tick
+    if (elapsedUs < STEERING_PID_INTERVAL_US - CONTROL_TICK_US / 2) {
         return;  // Not time for PID update yet
     }
-    lastPidUpdate = now;
+    if (lastPidUpdateUs > 0 && elapsedUs >= 2 * STEERING_PID_INTERVAL_US - CONTROL_TICK_US / 2) {
+        pidMissedPeriods += (elapsedUs + CONTROL_TICK_US / 2) / STEERING_PID_INTERVAL_US - 1;
+    }
+    lastPidUpdateUs = now;
+    lastPidDtUs = min(elapsedUs, (int64_t)STEERING_PID_MAX_DT_US);
 
     // Skip normal updates if in backup mode
     if (backupModeActive) {
         return;
     }
 
-    if (!state.isEnabled() || speedPercent == 0) {
-        stop();
+    if (!state.isEnabled()) {
+        emergencyStop();
+        return;
+    }
+
+    // Driver has cut the outputs already, start over from 0 once it recovers
+    bool fault = checkFault();
+    if (fault && !faultActive) {
+        faultEvents++;
+        logger.warning("Motor driver fault", LogContext::Motor);
+    }
+    faultActive = fault;
+    if (fault) {
+        emergencyStop();
         return;
     }
 
-    if (checkFault()) {
+    if (speedPercent == 0) {
         stop();
         return;
     }
 
-    float currentRatio = calculateCurrentSteeringRatio();
-    float error = targetSteeringRatio - currentRatio;
-    
-    // Reset integral when changing direction
-    if (signbit(error) != signbit(lastSteeringError)) {
-        steeringIntegral = 0;
+    if (driveMode == DriveMode::Velocity) {
+        updateVelocityControl(lastPidDtUs / 1000000.0f);
+        return;
     }
-    
-    steeringIntegral += error * (STEERING_PID_INTERVAL / 1000.0f);
-    steeringIntegral = constrain(steeringIntegral, -STEERING_INTEGRAL_LIMIT, STEERING_INTEGRAL_LIMIT);
-    
-    float derivative = (error - lastSteeringError) / (STEERING_PID_INTERVAL / 1000.0f);
-    
-    float correction = (KP * error) + (KI * steeringIntegral) + (KD * derivative);
-    correction = constrain(correction, -1.0f, 1.0f);
-    
-    float basePwm = (speedPercent / 100.0f) * ((1 << MOTOR_PWM_RESOLUTION) - 1);
-    float leftPwm = basePwm * (1.0f + correction) * leftMotorScale;
-    float rightPwm = basePwm * (1.0f - correction) * rightMotorScale;
-    
-    if (speedPercent < 0) {
-        leftPwm = -leftPwm;
-        rightPwm = -rightPwm;
+
+    updateSteering();
+}
+
+void MotorController::updateSteering() {
+#if STEERING_FIXED_POINT
+    SteeringMixerQ16::Output out = steeringMixer.update(SteeringMixerQ16::speed(leftMotor.getVelocityMmS()),
+                                                        SteeringMixerQ16::speed(rightMotor.getVelocityMmS()),
+                                                        lastPidDtUs);
+#else
+    SteeringMixer::Output out = steeringMixer.update(leftMotor.getVelocityMmS(), rightMotor.getVelocityMmS(),
+                                                     lastPidDtUs);
+#endif
+    applyPwm(out.left, out.right);
+}
+
+void MotorController::updateVelocityControl(float dt) {
+    // Same split as open loop: positive steering speeds up the left wheel
+    float speed = speedPercent / 100.0f * WHEEL_MAX_SPEED_MM_S;
+    float leftTarget = speed * (1.0f + targetSteeringRatio);
+    float rightTarget = speed * (1.0f - targetSteeringRatio);
+
+    applyPwm(wheelLoopPwm(leftLoop, leftMotor, leftTarget, leftCurve, leftMotorScale, dt),
+             wheelLoopPwm(rightLoop, rightMotor, rightTarget, rightCurve, rightMotorScale, dt));
+}
+
+float MotorController::wheelLoopPwm(WheelLoop& loop, const Motor& motor, float target,
+                                    const SpeedCurve& curve, float scale, float dt) {
+    loop.target = target;
+    // Single channel encoder, the direction is whatever we are driving it
+    float measured = motor.getVelocityMmS();
+    if (motor.getCurrentPwm() < 0) measured = -measured;
+    float error = target - measured;
+
+    // Feedforward gets close, the PID makes up for battery, floor and load
+    float feedforward = 0;
+    if (target != 0 && curve.isValid()) {
+        feedforward = copysignf(curve.pwmPercentFor(fabsf(target)), target);
+    } else if (target != 0) {
+        feedforward = copysignf(WHEEL_FF_OFFSET_PERCENT + fabsf(target) * WHEEL_FF_PERCENT_PER_MM_S, target) * scale;
     }
+    float derivative = (error - loop.lastError) / dt;
+    loop.lastError = error;
 
-    // Apply PWM directly
-    leftMotor.setPwm(leftPwm);
-    rightMotor.setPwm(rightPwm);
-    
-    lastSteeringError = error;
+    float output = feedforward + WHEEL_PID_KP * error + loop.integral + WHEEL_PID_KD * derivative;
+    // Don't integrate further into saturation
+    if (fabsf(output) < 100.0f || signbit(error) != signbit(output)) {
+        loop.integral = constrain(loop.integral + WHEEL_PID_KI * error * dt,
+                                  -WHEEL_PID_INTEGRAL_LIMIT, WHEEL_PID_INTEGRAL_LIMIT);
+    }
+    return percentToPwm(constrain(output, -100.0f, 100.0f));
 }
 
 void MotorController::stop() {
+    if (sequenceStep != SequenceStep::Idle) {
+        abortSequence();
+    }
     speedPercent = 0;
     targetSteeringRatio = 0;
-    steeringIntegral = 0;
-    lastSteeringError = 0;
-    leftMotor.stop();
-    rightMotor.stop();
+    steeringMixer.setTarget(0, 0);
+    steeringMixer.reset();
+    leftLoop = WheelLoop();
+    rightLoop = WheelLoop();
+    applyPwm(0, 0);
+}
+
+void MotorController::emergencyStop() {
+    stop();
+    forcePwm(0, 0);
+}
+
+void MotorController::forcePwm(int left, int right) {
+    leftSlew.reset(left);
+    rightSlew.reset(right);
+    writePwm(left, right);
+}
+
+void MotorController::applyPwm(int left, int right) {
+    leftSlew.setTarget(left);
+    rightSlew.setTarget(right);
+    if (slewProfile == SlewProfile::Off) {
+        writePwm(left, right);
+    }
+}
+
+void MotorController::writePwm(int left, int right) {
+    bool leftPending = leftMotor.stagePwm(left);
+    bool rightPending = rightMotor.stagePwm(right);
+    if (!leftPending && !rightPending) {
+        return;
+    }
+#if MOTOR_PWM_BACKEND_LEDC
+    // Back to back with nothing in between, so both land in the same PWM period
+    portENTER_CRITICAL(&pwmLock);
+    if (leftPending) leftMotor.commitPwm();
+    if (rightPending) rightMotor.commitPwm();
+    portEXIT_CRITICAL(&pwmLock);
+#else
+    if (leftPending) leftMotor.commitPwm();
+    if (rightPending) rightMotor.commitPwm();
+#endif
 }
 
 bool MotorController::checkFault() {
@@ -113,46 +252,159 @@ bool MotorController::checkFault() {
     return digitalRead(faultPin) == LOW;
 }
 
-void MotorController::test() {
-    if (!state.isEnabled()) {
+void MotorController::startTest() {
+    if (!state.isEnabled() || sequenceStep != SequenceStep::Idle) {
         return;
     }
-    
-    const int testPwm = 1023;  // Half of 10-bit range (1024)
-    
-    // Test forward
-    leftMotor.setPwm(testPwm);
-    rightMotor.setPwm(testPwm);
-    delay(2000);
-    
-    // Test backward
-    leftMotor.setPwm(-testPwm);
-    rightMotor.setPwm(-testPwm);
-    delay(2000);
-    
-    stop();
+    enterStep(SequenceStep::TestForward);
 }
 
-void MotorController::calibrateMotors() {
-    if (!state.isEnabled()) return;
-    
+void MotorController::startCalibration() {
+    if (!state.isEnabled() || sequenceStep != SequenceStep::Idle) {
+        // A running calibration keeps its status, otherwise the UI would show the last result
+        if (calibrationStatus != CalibrationStatus::Running) {
+            calibrationStatus = CalibrationStatus::Rejected;
+        }
+        logger.warning("Calibration rejected - motors off or a sequence is running", LogContext::Motor);
+        return;
+    }
+
     logger.info("Starting motor calibration...", LogContext::Motor);
-    delay(1);
-    
-    // Reset speed buffers
-    leftMotor.stop();
-    rightMotor.stop();
-    delay(100);
-    
+    calibrationStatus = CalibrationStatus::Running;
+    enterStep(SequenceStep::CalibrationSettle);
+}
+
+uint8_t MotorController::getCalibrationProgress() const {
+    const unsigned long sweep = (unsigned long)MOTOR_CURVE_POINTS * MOTOR_CURVE_STEP_TIME;
+    const unsigned long total = 2 * MOTOR_CALIBRATION_SETTLE_TIME + MOTOR_CALIBRATION_TIME + sweep;
+    unsigned long elapsed = millis() - sequenceStepStart;
+    switch (sequenceStep) {
+        case SequenceStep::CalibrationSettle:
+            return min(elapsed, (unsigned long)MOTOR_CALIBRATION_SETTLE_TIME) * 100 / total;
+        case SequenceStep::CalibrationRun:
+            return (MOTOR_CALIBRATION_SETTLE_TIME + min(elapsed, (unsigned long)MOTOR_CALIBRATION_TIME)) * 100 / total;
+        case SequenceStep::CalibrationSweep:
+            // Level 0 runs a settle time longer, see advanceSequence()
+            return min(total, MOTOR_CALIBRATION_SETTLE_TIME + MOTOR_CALIBRATION_TIME + sweepIndex * MOTOR_CURVE_STEP_TIME +
+                              (sweepIndex > 0 ? MOTOR_CALIBRATION_SETTLE_TIME : 0) + elapsed) * 100 / total;
+        default:
+            return calibrationStatus == CalibrationStatus::Done ? 100 : 0;
+    }
+}
+
+void MotorController::enterStep(SequenceStep step) {
+    const int testPwm = 1023;  // Half of 10-bit range (1024)
     // Run motors at calibration PWM
     const int calibrationPwm = (1 << MOTOR_PWM_RESOLUTION) / 2;  // 50% of max PWM
-    leftMotor.setPwm(calibrationPwm);
-    rightMotor.setPwm(calibrationPwm);
-    delay(MOTOR_CALIBRATION_TIME);
-    
+
+    sequenceStep = step;
+    sequenceStepStart = millis();
+
+    // Calibration measures the motors themselves, so it skips the slew limiter
+    switch (step) {
+        case SequenceStep::TestForward:
+            applyPwm(testPwm, testPwm);
+            break;
+        case SequenceStep::TestBackward:
+            applyPwm(-testPwm, -testPwm);
+            break;
+        case SequenceStep::CalibrationSettle:
+            // Let the wheels spin down so the speed buffers start clean
+            forcePwm(0, 0);
+            break;
+        case SequenceStep::CalibrationRun:
+            calibrationLeftSum = 0;
+            calibrationRightSum = 0;
+            calibrationSamples = 0;
+            forcePwm(calibrationPwm, calibrationPwm);
+            break;
+        case SequenceStep::CalibrationSweep: {
+            // Both wheels at the same level, so the robot drives straight-ish
+            int pwm = percentToPwm(sweepPwmPercent(sweepIndex));
+            calibrationLeftSum = 0;
+            calibrationRightSum = 0;
+            calibrationSamples = 0;
+            forcePwm(pwm, pwm);
+            break;
+        }
+        case SequenceStep::Idle:
+            break;
+    }
+}
+
+// Advances test/calibration by at most one step per call, never blocks
+void MotorController::advanceSequence() {
+    if (!state.isEnabled()) {
+        emergencyStop();
+        return;
+    }
+
+    unsigned long elapsed = millis() - sequenceStepStart;
+    switch (sequenceStep) {
+        case SequenceStep::TestForward:
+            if (elapsed >= MOTOR_TEST_STEP_TIME) enterStep(SequenceStep::TestBackward);
+            break;
+        case SequenceStep::TestBackward:
+            if (elapsed >= MOTOR_TEST_STEP_TIME) {
+                sequenceStep = SequenceStep::Idle;
+                stop();
+            }
+            break;
+        case SequenceStep::CalibrationSettle:
+            if (elapsed >= MOTOR_CALIBRATION_SETTLE_TIME) enterStep(SequenceStep::CalibrationRun);
+            break;
+        case SequenceStep::CalibrationRun:
+            // Average over the whole run rather than the last few speed samples
+            calibrationLeftSum += leftMotor.getCurrentSpeed();
+            calibrationRightSum += rightMotor.getCurrentSpeed();
+            calibrationSamples++;
+            if (elapsed >= MOTOR_CALIBRATION_TIME) {
+                if (calculateScales()) {
+                    sweepIndex = 0;
+                    enterStep(SequenceStep::CalibrationSweep);
+                }
+            }
+            break;
+        case SequenceStep::CalibrationSweep: {
+            // The first level also has to spin down from the calibration run
+            unsigned long extra = sweepIndex == 0 ? MOTOR_CALIBRATION_SETTLE_TIME : 0;
+            if (elapsed >= MOTOR_CURVE_SETTLE_TIME + extra) {
+                calibrationLeftSum += leftMotor.getVelocityMmS();
+                calibrationRightSum += rightMotor.getVelocityMmS();
+                calibrationSamples++;
+            }
+            if (elapsed >= MOTOR_CURVE_STEP_TIME + extra) {
+                sweepLeftSpeed[sweepIndex] = calibrationSamples > 0 ? calibrationLeftSum / calibrationSamples : 0;
+                sweepRightSpeed[sweepIndex] = calibrationSamples > 0 ? calibrationRightSum / calibrationSamples : 0;
+                if (++sweepIndex < MOTOR_CURVE_POINTS) {
+                    enterStep(SequenceStep::CalibrationSweep);
+                } else {
+                    finishCalibration();
+                }
+            }
+            break;
+        }
+        case SequenceStep::Idle:
+            break;
+    }
+}
+
+float MotorController::sweepPwmPercent(size_t index) {
+    return MOTOR_CURVE_MIN_PWM + (100.0f - MOTOR_CURVE_MIN_PWM) * index / (MOTOR_CURVE_POINTS - 1);
+}
+
+bool MotorController::calculateScales() {
     // Get average speeds
-    float leftSpeed = leftMotor.getCurrentSpeed();
-    float rightSpeed = rightMotor.getCurrentSpeed();
+    float leftSpeed = calibrationSamples > 0 ? calibrationLeftSum / calibrationSamples : 0;
+    float rightSpeed = calibrationSamples > 0 ? calibrationRightSum / calibrationSamples : 0;
+    
+    if (leftSpeed <= 0 || rightSpeed <= 0) {
+        sequenceStep = SequenceStep::Idle;
+        calibrationStatus = CalibrationStatus::Failed;
+        logger.error("Calibration failed - no encoder pulses", LogContext::Motor);
+        stop();
+        return false;
+    }
     
     // Calculate scaling factors
     if (leftSpeed > rightSpeed) {
@@ -162,9 +414,51 @@ void MotorController::calibrateMotors() {
         rightMotorScale = leftSpeed / rightSpeed;
         leftMotorScale = 1.0f;
     }
-    
-    logger.info("Calibration complete - L:" + String(leftMotorScale) + 
+    steeringMixer.setScales(leftMotorScale, rightMotorScale);
+    logger.info("Motor scales - L:" + String(leftMotorScale) + 
                 " R:" + String(rightMotorScale), LogContext::Motor);
-    
+    return true;
+}
+
+void MotorController::finishCalibration() {
+    sequenceStep = SequenceStep::Idle;
+
+    float pwmPercent[MOTOR_CURVE_POINTS];
+    for (size_t i = 0; i < MOTOR_CURVE_POINTS; i++) {
+        pwmPercent[i] = sweepPwmPercent(i);
+    }
+    // A wheel that never got going leaves its curve empty, the scales still apply
+    if (!leftCurve.setPoints(pwmPercent, sweepLeftSpeed, MOTOR_CURVE_POINTS) ||
+        !rightCurve.setPoints(pwmPercent, sweepRightSpeed, MOTOR_CURVE_POINTS)) {
+        leftCurve.clear();
+        rightCurve.clear();
+        logger.warning("Speed sweep unusable, keeping scales only", LogContext::Motor);
+    }
+    steeringMixer.setCurves(leftCurve, rightCurve);
+
+    // Flash write stalls both cores for a few ms, once per calibration is fine
+    CalibrationStore::Calibration calibration;
+    calibration.leftScale = leftMotorScale;
+    calibration.rightScale = rightMotorScale;
+    calibration.leftCurve = leftCurve;
+    calibration.rightCurve = rightCurve;
+    calibrationStored = calibrationStore.save(calibration);
+    if (!calibrationStored) {
+        logger.error("Failed to store calibration", LogContext::Motor);
+    }
+
+    calibrationStatus = CalibrationStatus::Done;
+    logger.info("Calibration complete - L:" + String(leftMotorScale) +
+                " R:" + String(rightMotorScale) +
+                (leftCurve.isValid() ? " with speed curves" : ""), LogContext::Motor);
+
     stop();
 }
+
+void MotorController::abortSequence() {
+    if (calibrationStatus == CalibrationStatus::Running) {
+        calibrationStatus = CalibrationStatus::Failed;
+        logger.warning("Calibration aborted", LogContext::Motor);
+    }
+    sequenceStep = SequenceStep::Idle;
+}
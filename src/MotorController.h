@@ -1,9 +1,33 @@
 #pragma once
+#include <esp_timer.h>
 #include "Motor.h"
+#include "SpeedCurve.h"
+#include "CalibrationStore.h"
+#include "SteeringMixer.h"
+#include "SlewLimiter.h"
 #include "RobotState.h"
 #include "Logger.h"
 #include "config.h"
 
+enum class DriveMode {
+    OpenLoop,  // Scaled PWM, PID on the steering ratio only
+    Velocity   // PID per wheel on mm/s with feedforward
+};
+
+enum class SlewProfile {
+    Off,     // PWM steps straight through
+    Smooth,  // Gentle, below the traction limit
+    Fast
+};
+
+enum class CalibrationStatus {
+    Idle,
+    Running,
+    Done,
+    Failed,
+    Rejected  // Last request came while disabled or another sequence was running
+};
+
 class MotorController {
 private:
     Motor& leftMotor;
@@ -19,41 +43,120 @@ private:
     float targetSteeringRatio = 0;
     float currentSteering = 0;
     
-    // PID control for steering
-    const float KP = STEERING_PID_KP;
-    const float KI = STEERING_PID_KI;
-    const float KD = STEERING_PID_KD;
-    float steeringError = 0;
-    float steeringIntegral = 0;
-    float lastSteeringError = 0;
-    unsigned long lastPidUpdate = 0;  // Track last PID update time
+    // PID control for steering, ratio and mixing live in the mixer
+#if STEERING_FIXED_POINT
+    SteeringMixerQ16 steeringMixer;
+#else
+    SteeringMixer steeringMixer;
+#endif
+    int64_t lastPidUpdateUs = 0;      // esp_timer timestamp of the last PID run
+    uint32_t lastPidDtUs = 0;         // Measured dt used by the last PID run
+    uint32_t pidMissedPeriods = 0;    // PID periods skipped because the tick came late
+
+    void updateSteering();
+
+    DriveMode driveMode = DRIVE_VELOCITY_CONTROL ? DriveMode::Velocity : DriveMode::OpenLoop;
+    struct WheelLoop {
+        float target = 0;    // mm/s, signed
+        float integral = 0;  // PWM percent
+        float lastError = 0;
+    };
+    WheelLoop leftLoop;
+    WheelLoop rightLoop;
 
-    float calculateCurrentSteeringRatio() const;
+    void updateVelocityControl(float dt);
+    float wheelLoopPwm(WheelLoop& loop, const Motor& motor, float target,
+                       const SpeedCurve& curve, float scale, float dt);
 
     float leftMotorScale = DEFAULT_LEFT_MOTOR_SCALE;
     float rightMotorScale = DEFAULT_RIGHT_MOTOR_SCALE;
-    void calibrateMotors();
+    // Measured PWM -> speed, used instead of the scales once calibrated
+    SpeedCurve leftCurve;
+    SpeedCurve rightCurve;
+    CalibrationStore calibrationStore;
+    bool calibrationStored = false;
+
+    // Motor test and calibration run as time-sliced sequences advanced from update()
+    enum class SequenceStep {
+        Idle,
+        TestForward,
+        TestBackward,
+        CalibrationSettle,
+        CalibrationRun,
+        CalibrationSweep
+    };
+    SequenceStep sequenceStep = SequenceStep::Idle;
+    unsigned long sequenceStepStart = 0;
+    CalibrationStatus calibrationStatus = CalibrationStatus::Idle;
+    float calibrationLeftSum = 0;
+    float calibrationRightSum = 0;
+    uint32_t calibrationSamples = 0;
+    size_t sweepIndex = 0;
+    float sweepLeftSpeed[MOTOR_CURVE_POINTS] = {0};
+    float sweepRightSpeed[MOTOR_CURVE_POINTS] = {0};
+
+    void enterStep(SequenceStep step);
+    void advanceSequence();
+    bool calculateScales();
+    void finishCalibration();
+    static float sweepPwmPercent(size_t index);
+    void abortSequence();
 
     bool backupModeActive = false;  // Flag to prevent interference during backup
 
+#if MOTOR_PWM_BACKEND_LEDC
+    portMUX_TYPE pwmLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    // Every applyPwm() goes through these, advanced once per tick by update()
+    SlewProfile slewProfile = static_cast<SlewProfile>(MOTOR_SLEW_PROFILE);
+    SlewLimiter leftSlew;
+    SlewLimiter rightSlew;
+    int64_t lastSlewUs = 0;
+    void advanceSlew();
+    void writePwm(int left, int right);  // Straight to the motors
+    void forcePwm(int left, int right);  // Written at once, the limiters continue from there
+
+    bool faultActive = false;
+    uint32_t faultEvents = 0;
+
 public:
     MotorController(Motor& left, Motor& right, int flt, RobotState& s, Logger& log);
     void begin();
     void setSteering(float steering);
-    void stop();
+    void stop();           // Ramps down through the slew limiter
+    void emergencyStop();  // Zero at once, for faults, disabling and the stop button
     bool checkFault();
     void update();  // Moved from private to public
+    void applyPwm(int left, int right);  // Target for the slew limiter, or written at once when it is off
     
     float getSteering() const { return currentSteering; }
+    uint32_t getPidDtUs() const { return lastPidDtUs; }
+    uint32_t getPidMissedPeriods() const { return pidMissedPeriods; }
     unsigned long getLeftTimeSinceLastPulse() const { return leftMotor.getTimeSinceLastPulse(); }
     unsigned long getRightTimeSinceLastPulse() const { return rightMotor.getTimeSinceLastPulse(); }
     bool isFault() const { return digitalRead(faultPin) == LOW; }
+    uint32_t getPwmSkipped() const { return leftMotor.getPwmSkipped() + rightMotor.getPwmSkipped(); }
     void setSpeedPercent(float percent);
     float getSpeedPercent() const { return speedPercent; }
-    void test();
-    void calibrate() { calibrateMotors(); }
+    void setDriveMode(DriveMode mode);
+    DriveMode getDriveMode() const { return driveMode; }
+    void setSlewProfile(SlewProfile profile);
+    SlewProfile getSlewProfile() const { return slewProfile; }
+    uint32_t getFaultEvents() const { return faultEvents; }
+    float getLeftTargetMmS() const { return leftLoop.target; }
+    float getRightTargetMmS() const { return rightLoop.target; }
+    void startTest();          // Non-blocking, advanced by update()
+    void startCalibration();   // Non-blocking, advanced by update()
+    bool isSequenceRunning() const { return sequenceStep != SequenceStep::Idle; }
+    CalibrationStatus getCalibrationStatus() const { return calibrationStatus; }
+    uint8_t getCalibrationProgress() const;  // 0-100
     float getLeftScale() const { return leftMotorScale; }
     float getRightScale() const { return rightMotorScale; }
+    const SpeedCurve& getLeftCurve() const { return leftCurve; }
+    const SpeedCurve& getRightCurve() const { return rightCurve; }
+    bool isCalibrationStored() const { return calibrationStored; }
+    void clearCalibration();  // Back to the default scales, NVS wiped
     Motor& getLeftMotor() { return leftMotor; }
     Motor& getRightMotor() { return rightMotor; }
 
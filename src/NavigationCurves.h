@@ -0,0 +1,68 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// The speed sigmoid and the front steering amplification of RobotLogic,
+// tabulated at compile time by distance so a call is one index and one lerp
+// instead of a software exp()/pow(). Past the last entry the curves are flat.
+//
+// Interpolation error against the closed forms, over 0..MAX_SENSOR_DISTANCE
+// at the default 4mm step: speed < 0.2 percent (the sigmoid is only ~8mm
+// wide at SPEED_SIGMOID_SLOPE 0.12), amplification < 0.0001. The speed is
+// truncated to int by the caller, so it lands 1 percent off at most, and
+// only on the few mm around each integer crossing.
+namespace NavigationCurves {
+
+constexpr uint16_t STEP_MM = NAV_CURVE_STEP_MM;
+constexpr size_t SIZE = (MAX_SENSOR_DISTANCE + STEP_MM - 1) / STEP_MM + 1;
+
+// Halve into the range where the series converges fast, then square back up
+constexpr double expSeries(double x) {
+    int halvings = 0;
+    while (x > 0.5 || x < -0.5) {
+        x /= 2;
+        halvings++;
+    }
+    double term = 1, sum = 1;
+    for (int i = 1; i < 16; i++) {
+        term *= x / i;
+        sum += term;
+    }
+    while (halvings-- > 0) sum *= sum;
+    return sum;
+}
+
+// Speed percent for the closest obstacle, sigmoid(x) = MIN + (MAX - MIN) / (1 + e^(-k*(x-midpoint)))
+constexpr float speedAt(uint32_t mm) {
+    double normalized = 1.0 / (1.0 + expSeries(-(double)SPEED_SIGMOID_SLOPE * ((double)mm - SPEED_THRESHOLD_MM)));
+    return MIN_SPEED_PERCENT + normalized * (MAX_SPEED_PERCENT - MIN_SPEED_PERCENT);
+}
+
+// Steering multiplier for the front distance, 1 + 4 * influence^4
+constexpr float amplificationAt(uint32_t mm) {
+    double influence = mm >= MAX_SENSOR_DISTANCE ? 0.0 : 1.0 - (double)mm / MAX_SENSOR_DISTANCE;
+    return 1.0 + 4 * influence * influence * influence * influence;
+}
+
+struct Table {
+    float values[SIZE];
+
+    constexpr Table(float (*curve)(uint32_t)) : values{} {
+        for (size_t i = 0; i < SIZE; i++) {
+            values[i] = curve(i * STEP_MM);
+        }
+    }
+
+    float operator()(uint16_t mm) const {
+        size_t i = mm / STEP_MM;
+        if (i >= SIZE - 1) return values[SIZE - 1];
+        float t = (float)(mm - i * STEP_MM) / STEP_MM;
+        return values[i] + t * (values[i + 1] - values[i]);
+    }
+};
+
+inline constexpr Table speed(speedAt);
+inline constexpr Table frontAmplification(amplificationAt);
+
+}  // namespace NavigationCurves
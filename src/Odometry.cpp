@@ -0,0 +1,45 @@
+#include "Odometry.h"
+
+int8_t Odometry::wheelDirection(const Motor& motor, int wheel) {
+    int16_t pwm = motor.getCurrentPwm();
+    if (pwm > 0) direction[wheel] = 1;
+    else if (pwm < 0) direction[wheel] = -1;
+    return direction[wheel];
+}
+
+void Odometry::update() {
+    uint32_t edges[2] = {leftMotor.getEdgeCount(), rightMotor.getEdgeCount()};
+    if (!started) {
+        lastEdges[0] = edges[0];
+        lastEdges[1] = edges[1];
+        started = true;
+    }
+
+    int8_t leftDir = wheelDirection(leftMotor, 0);
+    int8_t rightDir = wheelDirection(rightMotor, 1);
+    float left = leftDir * (float)(edges[0] - lastEdges[0]) / ENCODER_EDGES_PER_MM;
+    float right = rightDir * (float)(edges[1] - lastEdges[1]) / ENCODER_EDGES_PER_MM;
+    lastEdges[0] = edges[0];
+    lastEdges[1] = edges[1];
+
+    // Midpoint integration, exact enough for the few mm per tick
+    float forward = (left + right) / 2.0f;
+    float turn = (right - left) / ODOMETRY_WHEEL_BASE_MM;
+    float heading = pose.theta + turn / 2.0f;
+    pose.x += forward * cosf(heading);
+    pose.y += forward * sinf(heading);
+    pose.theta += turn;
+    if (pose.theta > PI) pose.theta -= TWO_PI;
+    else if (pose.theta < -PI) pose.theta += TWO_PI;
+    distanceTravelled += fabsf(forward);
+
+    float leftVelocity = leftDir * leftMotor.getVelocityMmS();
+    float rightVelocity = rightDir * rightMotor.getVelocityMmS();
+    linearVelocity = (leftVelocity + rightVelocity) / 2.0f;
+    angularVelocity = (rightVelocity - leftVelocity) / ODOMETRY_WHEEL_BASE_MM;
+}
+
+void Odometry::reset() {
+    pose = {0, 0, 0};
+    distanceTravelled = 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include "Motor.h"
+#include "config.h"
+
+// Dead reckoning from the wheel encoders. The encoders have a single channel,
+// so each wheel's direction is taken from the sign of its PWM, holding the last
+// direction while the PWM is 0 and the wheel coasts. Pose is relative to where
+// the robot was at the last reset: x forward, y left, theta counter-clockwise.
+class Odometry {
+public:
+    struct Pose {
+        float x;      // mm
+        float y;      // mm
+        float theta;  // rad, -pi..pi
+    };
+
+private:
+    Motor& leftMotor;
+    Motor& rightMotor;
+
+    Pose pose = {0, 0, 0};
+    float linearVelocity = 0;   // mm/s
+    float angularVelocity = 0;  // rad/s, positive turning left
+    float distanceTravelled = 0;  // mm, both directions
+    uint32_t lastEdges[2] = {0, 0};
+    int8_t direction[2] = {1, 1};
+    bool started = false;
+
+    int8_t wheelDirection(const Motor& motor, int wheel);
+
+public:
+    Odometry(Motor& left, Motor& right) : leftMotor(left), rightMotor(right) {}
+
+    void update();  // Once per control tick
+    void reset();   // Pose back to the origin, velocities kept
+
+    const Pose& getPose() const { return pose; }
+    float getLinearVelocity() const { return linearVelocity; }
+    float getAngularVelocity() const { return angularVelocity; }
+    float getDistanceTravelled() const { return distanceTravelled; }
+};
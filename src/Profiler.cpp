@@ -0,0 +1,87 @@
+#include "Profiler.h"
+
+#if ENABLE_PROFILER
+
+LoopProfiler profiler;
+
+size_t LoopProfiler::bucketFor(uint32_t cycles) {
+    if (cycles < SUB_BUCKETS) {
+        return cycles;
+    }
+    size_t msb = 31 - __builtin_clz(cycles);
+    size_t shift = msb - SUB_BUCKET_BITS;
+    size_t sub = (cycles >> shift) & (SUB_BUCKETS - 1);
+    return (shift + 1) * SUB_BUCKETS + sub;
+}
+
+uint32_t LoopProfiler::bucketUpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t shift = bucket / SUB_BUCKETS - 1;
+    uint64_t lower = (uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    uint64_t upper = lower + ((uint64_t)1 << shift) - 1;
+    return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+}
+
+uint32_t LoopProfiler::percentile(const Histogram& h, uint32_t permille) {
+    if (h.count == 0) return 0;
+    uint64_t target = ((uint64_t)h.count * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += h.buckets[i];
+        if (seen >= target) {
+            // Bucket bound can overshoot the largest sample actually seen
+            return min(bucketUpperBound(i), h.max);
+        }
+    }
+    return h.max;
+}
+
+void LoopProfiler::record(ProfileStage stage, uint32_t cycles) {
+    Histogram& h = histograms[static_cast<size_t>(stage)];
+    size_t bucket = bucketFor(cycles);
+
+    portENTER_CRITICAL(&lock);
+    h.buckets[bucket]++;
+    if (h.count == 0 || cycles < h.min) h.min = cycles;
+    if (cycles > h.max) h.max = cycles;
+    h.count++;
+    portEXIT_CRITICAL(&lock);
+}
+
+LoopProfiler::StageStats LoopProfiler::getStats(ProfileStage stage) {
+    // Copy out under the lock, walk the buckets outside of it
+    Histogram h;
+    portENTER_CRITICAL(&lock);
+    h = histograms[static_cast<size_t>(stage)];
+    portEXIT_CRITICAL(&lock);
+
+    StageStats stats;
+    stats.count = h.count;
+    stats.min = h.min;
+    stats.max = h.max;
+    stats.p50 = percentile(h, 500);
+    stats.p99 = percentile(h, 990);
+    return stats;
+}
+
+void LoopProfiler::reset() {
+    portENTER_CRITICAL(&lock);
+    memset(histograms, 0, sizeof(histograms));
+    portEXIT_CRITICAL(&lock);
+}
+
+const char* LoopProfiler::stageName(ProfileStage stage) {
+    switch(stage) {
+        case ProfileStage::Sensors: return "sensors";
+        case ProfileStage::Motors: return "motors";
+        case ProfileStage::Robot: return "robot";
+        case ProfileStage::Logger: return "logger";
+        case ProfileStage::Ota: return "ota";
+        case ProfileStage::Http: return "http";
+        default: return "unknown";
+    }
+}
+
+#endif
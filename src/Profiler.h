@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+enum class ProfileStage : uint8_t {
+    Sensors,
+    Motors,
+    Robot,
+    Logger,
+    Ota,
+    Http,
+    Count
+};
+
+#if ENABLE_PROFILER
+
+// Per-stage cycle histograms in fixed memory. Buckets are log-linear: each
+// power of two is split into SUB_BUCKETS linear buckets, so percentiles are
+// accurate to ~25% over the whole uint32_t range. Stages are recorded from
+// both tasks, so all access goes through a spinlock.
+class LoopProfiler {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 2;
+    static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = 32 * SUB_BUCKETS;
+    static constexpr size_t STAGES = static_cast<size_t>(ProfileStage::Count);
+
+    struct StageStats {
+        uint32_t count;
+        uint32_t min;   // All values in CPU cycles
+        uint32_t max;
+        uint32_t p50;
+        uint32_t p99;
+    };
+
+    void record(ProfileStage stage, uint32_t cycles);
+    StageStats getStats(ProfileStage stage);
+    void reset();
+    static const char* stageName(ProfileStage stage);
+
+private:
+    struct Histogram {
+        uint32_t buckets[BUCKETS];
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+    };
+    Histogram histograms[STAGES] = {};
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    static size_t bucketFor(uint32_t cycles);
+    static uint32_t bucketUpperBound(size_t bucket);
+    static uint32_t percentile(const Histogram& h, uint32_t permille);
+};
+
+extern LoopProfiler profiler;
+
+// Times one expression in CPU cycles (per-core counter, stages never migrate)
+#define PROFILE(stage, expr) do { \
+        uint32_t _profileStart = ESP.getCycleCount(); \
+        expr; \
+        profiler.record(stage, ESP.getCycleCount() - _profileStart); \
+    } while (0)
+
+#else
+
+#define PROFILE(stage, expr) do { expr; } while (0)
+
+#endif
@@ -1,4 +1,5 @@
 #include "RobotLogic.h"
+#include "navigation/SensorGeometry.h"
 
 void RobotLogic::begin() {
     motors.begin();
@@ -6,55 +7,35 @@ void RobotLogic::begin() {
 }
 
 void RobotLogic::update() {
-    if (!state.isAuto()) {
-        return;  // Only run autonomous logic in Auto mode
+    // Every tick in every mode, manual driving moves the robot too
+    odometry.update();
+    updateGrid();
+    if (ODOMETRY_LOG_INTERVAL > 0 && millis() - lastOdometryLog >= ODOMETRY_LOG_INTERVAL) {
+        lastOdometryLog = millis();
+        const Odometry::Pose& pose = odometry.getPose();
+        logger.debug("Pose x:" + String(pose.x, 0) + " y:" + String(pose.y, 0) +
+                     " th:" + String(pose.theta * RAD_TO_DEG, 1), LogContext::Navigation);
     }
 
-    stuckDetector.update();
-
-    // Handle backup maneuver with highest priority
-    if (backupUntil > 0) {
-        unsigned long currentTime = millis();
-        // Currently in backup sequence
-        if (currentTime >= backupUntil) {
-            logger.info("Backup complete", LogContext::Navigation);
-            backupUntil = 0;
-            motors.setBackupMode(false);  // Clear backup mode flag
-            motors.stop();
-            stuckDetector.notifyBackupCompleted(); // Notify detector of backup completion
-        } else {
-            // Force backup movement with direct motor control to avoid steering issues
-            int backupTime = backupUntil - currentTime;
-            logger.info("Backing up: " + String(backupTime) + "ms remaining", LogContext::Navigation);
-            
-            // Ensure backup mode is set
-            motors.setBackupMode(true);
-            
-            // Bypass normal motor control to ensure straight backup
-            // Force direct PWM control instead of using speed + steering
-            int pwm = (STUCK_BACKUP_SPEED / 100.0f) * ((1 << MOTOR_PWM_RESOLUTION) - 1);
-            motors.getLeftMotor().setPwm(-pwm);  // Negative for backward
-            motors.getRightMotor().setPwm(-pwm);  // Negative for backward
-            
-            return;
-        }
+    if (state.isAuto()) {
+        stuckDetector.update();
+    }
+
+    // Handle backup maneuver with highest priority, in any mode so the
+    // manual backup test runs to completion as well
+    if (backupPhase != BackupPhase::Idle) {
+        advanceBackup();
+        return;
+    }
+
+    if (!state.isAuto()) {
+        return;  // Only run autonomous logic in Auto mode
     }
 
     // Check for stuck condition after handling any active backup
     if (stuckDetector.isStuck()) {
-        // Start backup sequence
         logger.info("STUCK DETECTED! Starting backup maneuver", LogContext::Navigation);
-        
-        // Complete stop before changing direction
-        motors.stop();
-        delay(50); // Short delay to ensure motors stop
-        
-        // Set backup duration
-        backupUntil = millis() + random(STUCK_BACKUP_MIN_TIME, STUCK_BACKUP_MAX_TIME);
-        
-        // Start backup immediately
-        motors.setSteering(0);
-        motors.setSpeedPercent(STUCK_BACKUP_SPEED);
+        startBackup(random(STUCK_BACKUP_MIN_TIME, STUCK_BACKUP_MAX_TIME));
         return;
     }
 
@@ -63,56 +44,119 @@ void RobotLogic::update() {
         return;  // Only update when new measurements are available
     }
 
-    // Normal navigation logic
-    uint16_t front = sensors.getFrontDistance();
-    uint16_t left = sensors.getLeftDistance();
-    uint16_t right = sensors.getRightDistance();
+    // Normal navigation logic, on where the obstacles are now rather than
+    // when each echo came back
+    uint32_t now = micros();
+    NavigationInputs inputs;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        inputs.distance[i] = sensors.predictDistance(i, now);
+        inputs.fresh[i] = unseenReading[i];
+        inputs.closing[i] = sensors.getClosingMmS(i);
+        unseenReading[i] = false;
+    }
+    inputs.pose = odometry.getPose();
+    inputs.nowMs = millis();
+    inputs.grid = &grid;
 
-    float steering = calculateSteering(left, right, front);
-    motors.setSteering(steering);
-    motors.setSpeedPercent(calculateTargetSpeed(front));
+    NavigationCommand command = navigation->decide(inputs);
+    motors.setSteering(command.steering);
+    motors.setSpeedPercent(governor.limit(inputs, odometry.getLinearVelocity(), command.speedPercent));
     
     sensors.clearNewMeasurementsFlag();
 }
 
-float RobotLogic::calculateSteering(uint16_t left, uint16_t right, uint16_t front) {
-    // Normalize distances to 0-1 range (0 = obstacle close, 1 = clear path)
-    float leftClearance = constrain((float)left / MAX_SENSOR_DISTANCE, 0.0f, 1.0f);
-    float rightClearance = constrain((float)right / MAX_SENSOR_DISTANCE, 0.0f, 1.0f);
-    
-    // Calculate base steering from side sensors
-    // Use square root to make the response more gentle
-    float steering = (0.3 * rightClearance + (rightClearance, 2)) - (0.3 * leftClearance + (leftClearance, 2));
-    
-    // In near-deadzone situations (almost equal side clearances), 
-    // pick turn direction based on smallest noise difference
-    if (abs(steering) < 0.05f) {
-        steering = (left < right) ? -0.05f : 0.05f;
+void RobotLogic::setNavigationMode(NavigationMode mode) {
+    NavigationStrategy* next = mode == NavigationMode::Vfh ? static_cast<NavigationStrategy*>(&vfh) : &reactive;
+    if (next == navigation) return;
+    next->reset();  // Memory from the last time it ran is stale
+    navigation = next;
+    logger.info(String("Navigation: ") + navigation->name(), LogContext::Navigation);
+}
+
+void RobotLogic::setGovernorEnabled(bool enabled) {
+    if (enabled == governor.isEnabled()) return;
+    governor.setEnabled(enabled);
+    governor.reset();
+    logger.info(String("Speed governor: ") + (enabled ? "on" : "off"), LogContext::Navigation);
+}
+
+void RobotLogic::resetOdometry() {
+    odometry.reset();
+    vfh.reset();  // Both hold points in the old frame
+    grid.clear();
+}
+
+// Every tick in every mode, so the map keeps up during backups and manual driving
+void RobotLogic::updateGrid() {
+    const Odometry::Pose& pose = odometry.getPose();
+    grid.recenter(pose.x, pose.y);
+    grid.decay(millis());
+    uint32_t now = micros();
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        if (sensors.getLastReadTime(i) == lastReadTime[i]) continue;
+        lastReadTime[i] = sensors.getLastReadTime(i);
+        unseenReading[i] = true;
+        // A missed echo leaves the filter holding the old distance, that is
+        // where the obstacle was, not where it is from here
+        if (sensors.getRawDistance(i) >= MAX_SENSOR_DISTANCE) continue;
+        SensorBeam beam = sensorBeam(pose, i);
+        grid.addReading(beam.x, beam.y, beam.dx, beam.dy, sensors.predictDistance(i, now));
     }
-    
-    // Get normalized front distance influence (0 = far, 1 = close)
-    // Start influence even earlier but make it more gradual
-    float frontInfluence = 1.0f - constrain((float)front / (MAX_SENSOR_DISTANCE ), 0.0f, 1.0f);
-    
-    // Reduce multiplier from 0.5 to 0.35 for gentler influence
-    steering *= (1.0f + 4 * pow(frontInfluence, 4));  // Max 1.35x amplification when front is blocked
-    
-    return constrain(steering, -1.0f, 1.0f);
 }
 
-int RobotLogic::calculateTargetSpeed(uint16_t front) {
-    // Find minimum distance from all sensors
-    uint16_t minDistance = min(front, min(sensors.getLeftDistance(), sensors.getRightDistance()));
-    
-    // Use sigmoid function for smooth speed transition
-    // sigmoid(x) = MIN_SPEED + (MAX_SPEED - MIN_SPEED) * (1 / (1 + e^(-k*(x-midpoint))))
-    float k = SPEED_SIGMOID_SLOPE;          // Controls steepness of transition
-    float midpoint = SPEED_THRESHOLD_MM;    // Inflection point of sigmoid
-    
-    float normalizedSpeed = 1.0f / (1.0f + exp(-k * (minDistance - midpoint)));
-    
-    // Convert to speed percentage between MIN and MAX
-    return MIN_SPEED_PERCENT + normalizedSpeed * (MAX_SPEED_PERCENT - MIN_SPEED_PERCENT);
+void RobotLogic::startBackup(unsigned long duration) {
+    // Complete stop before changing direction, backup mode keeps the PID off the motors
+    motors.stop();
+    motors.setBackupMode(true);
+    backupDuration = duration;
+    backupPhase = BackupPhase::Stopping;
+    backupPhaseStart = millis();
+}
+
+void RobotLogic::advanceBackup() {
+    unsigned long elapsed = millis() - backupPhaseStart;
+
+    if (state.isOff()) {
+        backupPhase = BackupPhase::Idle;
+        motors.setBackupMode(false);
+        motors.stop();
+        return;
+    }
+
+    if (backupPhase == BackupPhase::Stopping) {
+        if (elapsed < STUCK_BACKUP_STOP_TIME) {
+            return;  // Let the motors spin down
+        }
+        logger.info("Backing up for " + String(backupDuration) + "ms", LogContext::Navigation);
+        backupPhase = BackupPhase::Reversing;
+        backupPhaseStart = millis();
+        elapsed = 0;
+    }
+
+    if (elapsed >= backupDuration) {
+        logger.info("Backup complete", LogContext::Navigation);
+        backupPhase = BackupPhase::Idle;
+        motors.setBackupMode(false);  // Clear backup mode flag
+        motors.stop();
+        stuckDetector.notifyBackupCompleted(); // Notify detector of backup completion
+        return;
+    }
+
+    // Bypass normal motor control to ensure straight backup
+    // Force direct PWM control instead of using speed + steering
+    int pwm = (STUCK_BACKUP_SPEED / 100.0f) * ((1 << MOTOR_PWM_RESOLUTION) - 1);
+    motors.applyPwm(-pwm, -pwm);  // Negative for backward, repeats are skipped
+}
+
+int RobotLogic::getBackupTimeRemaining() const {
+    switch (backupPhase) {
+        case BackupPhase::Stopping:
+            return backupDuration;
+        case BackupPhase::Reversing:
+            return max(0L, (long)backupDuration - (long)(millis() - backupPhaseStart));
+        default:
+            return 0;
+    }
 }
 
 // Add this method to test backup
@@ -122,19 +166,5 @@ void RobotLogic::testBackup() {
     }
     
     logger.info("Starting backup test", LogContext::Navigation);
-    
-    // Complete stop before changing direction
-    motors.stop();
-    delay(50); // Short delay to ensure motors stop
-    
-    // Set backup mode to prevent interference from motor controller updates
-    motors.setBackupMode(true);
-    
-    // Set backup duration
-    backupUntil = millis() + 2000;  // 2 seconds backup
-    
-    // Start backup immediately - use direct PWM control
-    int pwm = (STUCK_BACKUP_SPEED / 100.0f) * ((1 << MOTOR_PWM_RESOLUTION) - 1);
-    motors.getLeftMotor().setPwm(-pwm);  // Negative for backward
-    motors.getRightMotor().setPwm(-pwm);  // Negative for backward
+    startBackup(2000);  // 2 seconds backup
 }
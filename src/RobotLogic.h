@@ -5,6 +5,16 @@
 #include "RobotState.h"
 #include "config.h"
 #include "StuckDetector.h"
+#include "Odometry.h"
+#include "navigation/ReactiveStrategy.h"
+#include "navigation/VfhStrategy.h"
+#include "navigation/OccupancyGrid.h"
+#include "navigation/SpeedGovernor.h"
+
+enum class NavigationMode {
+    Reactive,  // Steering formula over the current readings
+    Vfh        // Vector field histogram over remembered obstacles
+};
 
 class RobotLogic {
 private:
@@ -13,16 +23,39 @@ private:
     Logger& logger;
     RobotState& state;
     StuckDetector stuckDetector;
-    unsigned long backupUntil = 0;  // Timestamp when to stop backing up
+    Odometry odometry;
+    unsigned long lastOdometryLog = 0;
+
+    ReactiveStrategy reactive;
+    VfhStrategy vfh;
+    NavigationStrategy* navigation = NAV_VFH ? static_cast<NavigationStrategy*>(&vfh) : &reactive;
+    SpeedGovernor governor;
+
+    OccupancyGrid grid;
+    unsigned long lastReadTime[NUM_SENSORS] = {0};  // Tells fresh readings from repeats
+    bool unseenReading[NUM_SENSORS] = {false};      // Fresh since navigation last ran
+    void updateGrid();
+
+    // Backup is a time-sliced sequence: stop briefly, then reverse for backupDuration
+    enum class BackupPhase {
+        Idle,
+        Stopping,
+        Reversing
+    };
+    BackupPhase backupPhase = BackupPhase::Idle;
+    unsigned long backupPhaseStart = 0;
+    unsigned long backupDuration = 0;
+
+    void startBackup(unsigned long duration);
+    void advanceBackup();
 
-    float calculateSteering(uint16_t left, uint16_t right, uint16_t front);
     float calculateFrontMultiplier(uint16_t front);
-    int calculateTargetSpeed(uint16_t front);
 
 public:
     RobotLogic(MotorController& m, DistanceSensors& s, Logger& l, RobotState& st)
         : motors(m), sensors(s), logger(l), state(st), 
-          stuckDetector(m.getLeftMotor(), m.getRightMotor(), s) {}
+          stuckDetector(m.getLeftMotor(), m.getRightMotor(), s),
+          odometry(m.getLeftMotor(), m.getRightMotor()) {}
     
     void begin();
     void update();
@@ -31,9 +64,17 @@ public:
     bool isOff() const { return state.isOff(); }
     void setState(OperationMode newMode) { state.setMode(newMode); }
     bool isStuck() const { return stuckDetector.isStuck(); }
-    int getBackupTimeRemaining() const { 
-        return backupUntil > 0 ? backupUntil - millis() : 0;
-    }
+    int getBackupTimeRemaining() const;
     void testBackup();  // Add test function for backup
     void resetStuckDetection() { stuckDetector.resetDetection(); }
+    const Odometry& getOdometry() const { return odometry; }
+    void resetOdometry();
+
+    void setNavigationMode(NavigationMode mode);
+    NavigationMode getNavigationMode() const { return navigation == &vfh ? NavigationMode::Vfh : NavigationMode::Reactive; }
+    const char* getNavigationName() const { return navigation->name(); }
+    const VfhStrategy& getVfh() const { return vfh; }
+    const OccupancyGrid& getOccupancyGrid() const { return grid; }
+    void setGovernorEnabled(bool enabled);
+    const SpeedGovernor& getGovernor() const { return governor; }
 };
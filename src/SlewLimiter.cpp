@@ -0,0 +1,33 @@
+#include "SlewLimiter.h"
+
+void SlewLimiter::setLimits(float rateLimit, float jerkLimit) {
+    maxRate = rateLimit;
+    maxJerk = jerkLimit;
+    rate = 0;
+}
+
+float SlewLimiter::step(float dt) {
+    if (maxRate <= 0) {
+        output = target;
+        rate = 0;
+        return output;
+    }
+    float error = target - output;
+    if (dt <= 0 || (error == 0 && rate == 0)) return output;
+
+    // Fastest rate that can still be brought back to 0 by the time the target is reached
+    float stopping = sqrtf(2.0f * maxJerk * fabsf(error));
+    float desired = copysignf(min(maxRate, stopping), error);
+    float maxChange = maxJerk * dt;
+    rate += constrain(desired - rate, -maxChange, maxChange);
+
+    float next = output + rate * dt;
+    if ((target - next) * error <= 0) {
+        // Reached or stepped over it, the last bit of deceleration is lost in the tick
+        output = target;
+        rate = 0;
+    } else {
+        output = next;
+    }
+    return output;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <Arduino.h>
+
+// Jerk-limited ramp from the PWM a controller asks for to the PWM a motor gets.
+// The rate of change is capped (how hard the wheel is asked to accelerate) and
+// so is the change of that rate, so steps become S-curves and reversals pass
+// through 0 instead of jumping across it. Units are PWM counts and seconds.
+class SlewLimiter {
+public:
+    // maxRate 0 disables limiting, the output then follows the target at once
+    void setLimits(float maxRate, float maxJerk);
+    void setTarget(float value) { target = value; }
+    float step(float dt);       // Advances and returns the output
+    void reset(float value = 0) { target = output = value; rate = 0; }
+
+    float getOutput() const { return output; }
+    float getTarget() const { return target; }
+    bool isSettled() const { return output == target; }
+
+private:
+    float maxRate = 0;  // counts/s
+    float maxJerk = 0;  // counts/s^2
+    float target = 0;
+    float output = 0;
+    float rate = 0;
+};
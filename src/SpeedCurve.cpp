@@ -0,0 +1,39 @@
+#include "SpeedCurve.h"
+
+bool SpeedCurve::setPoints(const float* pwmPercent, const float* speedMmS, size_t n) {
+    count = 0;
+    for (size_t i = 0; i < n && i < MAX_POINTS; i++) {
+        float s = speedMmS[i] < VELOCITY_MIN_MM_S ? 0 : speedMmS[i];
+        if (count > 0 && s <= speed[count - 1]) {
+            // Still stalled: move the deadband edge up. Noise going backwards is dropped.
+            if (s == 0) pwm[count - 1] = pwmPercent[i];
+            continue;
+        }
+        pwm[count] = pwmPercent[i];
+        speed[count] = s;
+        count++;
+    }
+    if (count < 2) {
+        count = 0;
+        return false;
+    }
+    return true;
+}
+
+float SpeedCurve::interpolate(const float* xs, const float* ys, size_t n, float x) {
+    // Piecewise linear, the end segments extend past the measured range
+    size_t i = 1;
+    while (i < n - 1 && x > xs[i]) i++;
+    float t = (x - xs[i - 1]) / (xs[i] - xs[i - 1]);
+    return ys[i - 1] + t * (ys[i] - ys[i - 1]);
+}
+
+float SpeedCurve::pwmPercentFor(float speedMmS) const {
+    if (speedMmS <= 0 || !isValid()) return 0;
+    return constrain(interpolate(speed, pwm, count, speedMmS), 0.0f, 100.0f);
+}
+
+float SpeedCurve::speedFor(float pwmPercent) const {
+    if (pwmPercent <= 0 || !isValid()) return 0;
+    return max(0.0f, interpolate(pwm, speed, count, pwmPercent));
+}
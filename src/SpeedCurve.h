@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Measured PWM -> wheel speed of one motor, filled in by the calibration sweep.
+// Points are kept only where the speed strictly increases, so the curve can be
+// inverted. Runs of stalled points collapse into the last one, which marks the
+// edge of the deadband.
+class SpeedCurve {
+public:
+    static constexpr size_t MAX_POINTS = MOTOR_CURVE_POINTS;
+
+    // Points ascending by PWM, false (and cleared) if fewer than two are usable
+    bool setPoints(const float* pwmPercent, const float* speedMmS, size_t count);
+    void clear() { count = 0; }
+    bool isValid() const { return count >= 2; }
+
+    float pwmPercentFor(float speedMmS) const;  // Unsigned, 0 for 0, capped at 100
+    float speedFor(float pwmPercent) const;     // Unsigned mm/s
+
+    size_t size() const { return count; }
+    float getPwmPercent(size_t i) const { return pwm[i]; }
+    float getSpeed(size_t i) const { return speed[i]; }
+
+private:
+    float pwm[MAX_POINTS] = {0};
+    float speed[MAX_POINTS] = {0};
+    uint8_t count = 0;
+
+    static float interpolate(const float* xs, const float* ys, size_t n, float x);
+};
@@ -0,0 +1,140 @@
+#include "SteeringMixer.h"
+
+static constexpr float MAX_PWM = (1 << MOTOR_PWM_RESOLUTION) - 1;
+
+float SteeringMixer::measuredRatio(float leftSpeed, float rightSpeed) const {
+    // Avoid division by zero and very small values
+    if (abs(leftSpeed) < VELOCITY_MIN_MM_S && abs(rightSpeed) < VELOCITY_MIN_MM_S) {
+        return 0.0f;
+    }
+
+    // Calculate normalized difference between motors
+    // Positive ratio = turning right (right motor slower)
+    float avgSpeed = (abs(leftSpeed) + abs(rightSpeed)) / 2.0f;
+    if (avgSpeed < VELOCITY_MIN_MM_S) return 0.0f;
+    
+    // Adjust ratio calculation based on direction of movement
+    float ratio;
+    if (speedPercent >= 0) {
+        ratio = (leftSpeed - rightSpeed) / (2.0f * avgSpeed);
+    } else {
+        ratio = (rightSpeed - leftSpeed) / (2.0f * avgSpeed);
+    }
+    return constrain(ratio, -1.0f, 1.0f);
+}
+
+SteeringMixer::Output SteeringMixer::update(float leftSpeed, float rightSpeed, uint32_t dtUs) {
+    float error = targetRatio - measuredRatio(leftSpeed, rightSpeed);
+    
+    // Reset integral when changing direction
+    if (signbit(error) != signbit(lastError)) {
+        integral = 0;
+    }
+    
+    // Use the measured interval, not the nominal one
+    float dt = dtUs / 1000000.0f;
+    integral += error * dt;
+    integral = constrain(integral, -STEERING_INTEGRAL_LIMIT, STEERING_INTEGRAL_LIMIT);
+    
+    float derivative = (error - lastError) / dt;
+    lastError = error;
+    
+    float correction = (STEERING_PID_KP * error) + (STEERING_PID_KI * integral) + (STEERING_PID_KD * derivative);
+    correction = constrain(correction, -1.0f, 1.0f);
+
+    float leftPwm, rightPwm;
+    if (leftCurve.isValid() && rightCurve.isValid()) {
+        float speed = fabsf(speedPercent) / 100.0f * WHEEL_MAX_SPEED_MM_S;
+        leftPwm = leftCurve.pwmPercentFor(speed * (1.0f + correction)) / 100.0f * MAX_PWM;
+        rightPwm = rightCurve.pwmPercentFor(speed * (1.0f - correction)) / 100.0f * MAX_PWM;
+    } else {
+        float basePwm = (speedPercent / 100.0f) * MAX_PWM;
+        leftPwm = basePwm * (1.0f + correction) * leftScale;
+        rightPwm = basePwm * (1.0f - correction) * rightScale;
+    }
+    
+    if (speedPercent < 0) {
+        leftPwm = -leftPwm;
+        rightPwm = -rightPwm;
+    }
+    return {(int)leftPwm, (int)rightPwm, correction};
+}
+
+void SteeringMixerQ16::setTarget(float ratio, float percent) {
+    targetRatio = Q16::from(ratio);
+    basePwm = Q16::from(percent / 100.0f * MAX_PWM);
+    targetSpeed = Q16::from(fabsf(percent) / 100.0f * WHEEL_MAX_SPEED_MM_S);
+    reverse = percent < 0;
+}
+
+void SteeringMixerQ16::setCurves(const SpeedCurve& left, const SpeedCurve& right) {
+    leftCurve.set(left);
+    rightCurve.set(right);
+}
+
+void SteeringMixerQ16::Curve::set(const SpeedCurve& curve) {
+    count = curve.isValid() ? curve.size() : 0;
+    for (size_t i = 0; i < count; i++) {
+        speed[i] = Q16::from(curve.getSpeed(i));
+        pwm[i] = Q16::from(curve.getPwmPercent(i));
+    }
+}
+
+int32_t SteeringMixerQ16::Curve::pwmFor(int32_t x) const {
+    if (x <= 0) return 0;
+    // Piecewise linear like SpeedCurve::interpolate, end segments extended
+    size_t i = 1;
+    while (i < (size_t)count - 1 && x > speed[i]) i++;
+    int32_t span = speed[i] - speed[i - 1];
+    int64_t percent = span > 0 ? pwm[i - 1] + (int64_t)(pwm[i] - pwm[i - 1]) * (x - speed[i - 1]) / span : pwm[i];
+    percent = constrain(percent, (int64_t)0, (int64_t)100 * Q16::ONE);
+    return percent * (int64_t)MAX_PWM / 100;
+}
+
+int32_t SteeringMixerQ16::measuredRatio(int32_t leftSpeed, int32_t rightSpeed) const {
+    leftSpeed = min(abs(leftSpeed), MAX_SPEED);
+    rightSpeed = min(abs(rightSpeed), MAX_SPEED);
+    if (leftSpeed < MIN_SPEED && rightSpeed < MIN_SPEED) return 0;
+
+    // (l - r) / (2 * avg) with avg = (l + r) / 2, same as the float path
+    int32_t sum = leftSpeed + rightSpeed;
+    if (sum < 2 * MIN_SPEED) return 0;
+    int32_t diff = reverse ? rightSpeed - leftSpeed : leftSpeed - rightSpeed;
+    // Rounded, |diff| <= sum so already within -1..1
+    return (diff * Q16::ONE + (diff < 0 ? -sum / 2 : sum / 2)) / sum;
+}
+
+SteeringMixerQ16::Output SteeringMixerQ16::update(int32_t leftSpeed, int32_t rightSpeed, uint32_t dtUs) {
+    int32_t error = targetRatio - measuredRatio(leftSpeed, rightSpeed);
+
+    if ((error < 0) != (lastError < 0)) {
+        integral = 0;
+    }
+
+    // error * dt with dt in seconds, by multiplying with 2^32 / 1e6 instead of dividing
+    integral += ((int64_t)error * dtUs * US_TO_Q32_SECONDS) >> 32;
+    integral = constrain(integral, -INTEGRAL_LIMIT, INTEGRAL_LIMIT);
+
+    // 1/dt in Q8 Hz, the only division besides the ratio
+    int32_t rate = (1000000u << 8) / max(dtUs, 1u);
+    int32_t derivative = ((int64_t)(error - lastError) * rate) >> 8;
+    lastError = error;
+
+    int64_t correction = ((int64_t)KP * error + (int64_t)KI * integral + (int64_t)KD * derivative) >> 16;
+    correction = constrain(correction, (int64_t)-Q16::ONE, (int64_t)Q16::ONE);
+
+    int32_t leftPwm, rightPwm;
+    if (leftCurve.count >= 2 && rightCurve.count >= 2) {
+        leftPwm = leftCurve.pwmFor(Q16::mul(targetSpeed, Q16::ONE + (int32_t)correction));
+        rightPwm = rightCurve.pwmFor(Q16::mul(targetSpeed, Q16::ONE - (int32_t)correction));
+    } else {
+        leftPwm = Q16::mul(Q16::mul(basePwm, Q16::ONE + (int32_t)correction), leftScale);
+        rightPwm = Q16::mul(Q16::mul(basePwm, Q16::ONE - (int32_t)correction), rightScale);
+    }
+
+    if (reverse) {
+        leftPwm = -leftPwm;
+        rightPwm = -rightPwm;
+    }
+    return {Q16::toInt(leftPwm), Q16::toInt(rightPwm), (int32_t)correction};
+}
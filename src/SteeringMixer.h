@@ -0,0 +1,118 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "SpeedCurve.h"
+
+// Open-loop steering: measured wheel speeds -> steering ratio -> PID -> PWM
+// split between the wheels. Two versions of the same math, MotorController
+// uses one of them depending on STEERING_FIXED_POINT:
+//
+// - SteeringMixer, float, the reference.
+// - SteeringMixerQ16, Q16.16 integers only. Targets, scales and speed curves
+//   are converted when they are set, speeds by the caller, so update() itself
+//   needs no FPU and can run where float use is off limits (ISRs, timer
+//   callbacks). That holds with speed curves calibrated too, the curve lookup
+//   is fixed point as well.
+//
+// Fed the same speeds (on the Q4 grid) the two agree within 0.0011 on the
+// correction and within 1 PWM count on the outputs, scales or curves alike;
+// test/test_steering_mixer checks that on randomized runs. The derivative term
+// (KD / dt = 20) is what stretches the rounding that far. Where the math is
+// discontinuous the rounding can put the two on different sides, after which
+// they follow different but equally valid paths:
+// - an error within rounding of 0 resets the integral in one but not the other,
+// - a speed right at the VELOCITY_MIN_MM_S cut-off zeroes the ratio in one,
+// - with curves, a wheel asked for about 0 mm/s can land on either side of the
+//   curve's step from 0 to the deadband edge.
+
+namespace Q16 {
+constexpr int32_t ONE = 1 << 16;
+constexpr int32_t from(float x) { return (int32_t)(x * ONE + (x < 0 ? -0.5f : 0.5f)); }
+inline float toFloat(int32_t x) { return x * (1.0f / ONE); }
+inline int32_t mul(int32_t a, int32_t b) { return (int32_t)(((int64_t)a * b) >> 16); }
+inline int32_t toInt(int32_t x) { return x >= 0 ? x >> 16 : -(-x >> 16); }  // Truncates like a float cast
+}  // namespace Q16
+
+class SteeringMixer {
+public:
+    struct Output {
+        int left;          // PWM counts
+        int right;
+        float correction;  // -1..1, positive speeds up the left wheel
+    };
+
+    void setTarget(float ratio, float percent) { targetRatio = ratio; speedPercent = percent; }
+    void setScales(float left, float right) { leftScale = left; rightScale = right; }
+    // Once both are valid the percent is a wheel speed and the curves give the PWM, scales unused
+    void setCurves(const SpeedCurve& left, const SpeedCurve& right) { leftCurve = left; rightCurve = right; }
+    void reset() { integral = 0; lastError = 0; }
+
+    // Speeds in mm/s, unsigned. dtUs since the last call, never 0.
+    Output update(float leftSpeed, float rightSpeed, uint32_t dtUs);
+    float getLastError() const { return lastError; }  // For the comparison test
+
+private:
+    float targetRatio = 0;
+    float speedPercent = 0;
+    float leftScale = DEFAULT_LEFT_MOTOR_SCALE;
+    float rightScale = DEFAULT_RIGHT_MOTOR_SCALE;
+    SpeedCurve leftCurve;
+    SpeedCurve rightCurve;
+    float integral = 0;
+    float lastError = 0;
+
+    float measuredRatio(float leftSpeed, float rightSpeed) const;
+};
+
+class SteeringMixerQ16 {
+public:
+    struct Output {
+        int left;            // PWM counts
+        int right;
+        int32_t correction;  // Q16
+    };
+
+    // Speeds go in as mm/s in Q4, so a speed difference shifted up 16 still fits 32 bits
+    static constexpr int SPEED_SHIFT = 4;
+    static int32_t speed(float mmS) { return (int32_t)(mmS * (1 << SPEED_SHIFT)); }
+
+    void setTarget(float ratio, float percent);
+    void setScales(float left, float right) { leftScale = Q16::from(left); rightScale = Q16::from(right); }
+    void setCurves(const SpeedCurve& left, const SpeedCurve& right);
+    void reset() { integral = 0; lastError = 0; }
+
+    Output update(int32_t leftSpeed, int32_t rightSpeed, uint32_t dtUs);
+    int32_t getLastError() const { return lastError; }  // Q16, for the comparison test
+
+private:
+    // SpeedCurve with speeds in mm/s and PWM percent, both Q16
+    struct Curve {
+        int32_t speed[SpeedCurve::MAX_POINTS];
+        int32_t pwm[SpeedCurve::MAX_POINTS];
+        uint8_t count = 0;
+
+        void set(const SpeedCurve& curve);
+        int32_t pwmFor(int32_t speed) const;  // Q16 counts, same as SpeedCurve::pwmPercentFor
+    };
+
+    static constexpr int32_t MIN_SPEED = VELOCITY_MIN_MM_S * (1 << SPEED_SHIFT);
+    static constexpr int32_t MAX_SPEED = 1000 << SPEED_SHIFT;  // Clamp, keeps (diff << 16) in range
+    static constexpr int32_t KP = Q16::from(STEERING_PID_KP);
+    static constexpr int32_t KI = Q16::from(STEERING_PID_KI);
+    static constexpr int32_t KD = Q16::from(STEERING_PID_KD);
+    static constexpr int32_t INTEGRAL_LIMIT = Q16::from(STEERING_INTEGRAL_LIMIT);
+    static constexpr int64_t US_TO_Q32_SECONDS = 4295;  // 2^32 / 1e6
+
+    int32_t targetRatio = 0;
+    int32_t basePwm = 0;  // Q16 counts, signed like speedPercent
+    int32_t targetSpeed = 0;  // Q16 mm/s, unsigned, for the curves
+    bool reverse = false;
+    int32_t leftScale = Q16::from(DEFAULT_LEFT_MOTOR_SCALE);
+    int32_t rightScale = Q16::from(DEFAULT_RIGHT_MOTOR_SCALE);
+    Curve leftCurve;
+    Curve rightCurve;
+    int32_t integral = 0;
+    int32_t lastError = 0;
+
+    int32_t measuredRatio(int32_t leftSpeed, int32_t rightSpeed) const;
+};
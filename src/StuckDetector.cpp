@@ -11,9 +11,13 @@ void StuckDetector::update() {
         sensors.getRightDistance()
     };
     
-    // Calculate and store deltas
+    // Calculate and store deltas, swapping the oldest out of the running sums
     for (int i = 0; i < 3; i++) {
-        deltaHistory[historyIndex][i] = (int16_t)currentReadings[i] - (int16_t)previousReadings[i];
+        int16_t delta = (int16_t)currentReadings[i] - (int16_t)previousReadings[i];
+        int16_t oldest = deltaHistory[historyIndex][i];
+        deltaSum[i] += delta - oldest;
+        deltaSumSquares[i] += (int32_t)delta * delta - (int32_t)oldest * oldest;
+        deltaHistory[historyIndex][i] = delta;
         previousReadings[i] = currentReadings[i];
     }
     
@@ -23,54 +27,29 @@ void StuckDetector::update() {
     if (!isInitialized && historyIndex >= STUCK_HISTORY_SIZE - 1) {
         isInitialized = true;
     }
+
+    distanceStuck = isDistanceStuck();
 }
 
 float StuckDetector::calculateDeltaStdDev(size_t sensorIndex) const {
-    float sum = 0.0f;
-    float mean = 0.0f;
-    
-    // Calculate mean of deltas
-    for (size_t i = 0; i < STUCK_HISTORY_SIZE; i++) {
-        mean += deltaHistory[i][sensorIndex];
-    }
-    mean /= STUCK_HISTORY_SIZE;
-    
-    // Calculate standard deviation of deltas
-    for (size_t i = 0; i < STUCK_HISTORY_SIZE; i++) {
-        float diff = deltaHistory[i][sensorIndex] - mean;
-        sum += diff * diff;
-    }
-    
-    return sqrt(sum / STUCK_HISTORY_SIZE);
+    // Integer sums are exact, so there is no drift to correct for
+    float mean = (float)deltaSum[sensorIndex] / STUCK_HISTORY_SIZE;
+    float variance = (float)deltaSumSquares[sensorIndex] / STUCK_HISTORY_SIZE - mean * mean;
+    return sqrt(max(variance, 0.0f));
 }
 
 float StuckDetector::getSpeedDependentThreshold() const {
-    // Get current PWM values to calculate speed
-    int16_t leftPwm = abs(leftMotor.getCurrentPwm());
-    int16_t rightPwm = abs(rightMotor.getCurrentPwm());
-    
-    // Use the average PWM as a measure of speed
-    float avgPwm = (leftPwm + rightPwm) / 2.0f;
-    
-    // Get maximum possible PWM value based on resolution
-    float maxPwm = (1 << MOTOR_PWM_RESOLUTION) - 1;
-    
-    // Calculate normalized speed between 0 and 1
-    float normalizedSpeed = avgPwm / maxPwm;
-    
-    // Apply a function that decreases threshold as speed increases
-    // At low speeds (close to 0), we use STUCK_MIN_STDDEV_LOW_SPEED
-    // At high speeds (close to 1), we use STUCK_MIN_STDDEV_HIGH_SPEED
+    // The summed PWM of both wheels is the measure of speed
+    float pwmSum = abs(leftMotor.getCurrentPwm()) + abs(rightMotor.getCurrentPwm());
     
     // If motors are stopped, use a high threshold
-    if (normalizedSpeed < 0.01f) {
+    if (pwmSum < STOPPED_PWM_SUM) {
         return STUCK_MIN_STDDEV_HIGH_SPEED; // Effectively disable stuck detection when stopped
     }
     
-    // Linear interpolation between high and low thresholds
-    return STUCK_MIN_STDDEV_LOW_SPEED + 
-           (STUCK_MIN_STDDEV_HIGH_SPEED - STUCK_MIN_STDDEV_LOW_SPEED) * 
-           (1.0f - normalizedSpeed);
+    // Linear from STUCK_MIN_STDDEV_HIGH_SPEED at standstill down to
+    // STUCK_MIN_STDDEV_LOW_SPEED at full speed, slope folded at compile time
+    return STUCK_MIN_STDDEV_HIGH_SPEED - THRESHOLD_PER_PWM * pwmSum;
 }
 
 bool StuckDetector::isEncoderStuck() const {
@@ -104,5 +83,5 @@ bool StuckDetector::isStuck() const {
         return false;
     }
     
-    return isEncoderStuck() || isDistanceStuck();
+    return isEncoderStuck() || distanceStuck;
 }
@@ -12,6 +12,9 @@ private:
     
     uint16_t previousReadings[3] = {0};  // Last readings [front,left,right]
     int16_t deltaHistory[STUCK_HISTORY_SIZE][3] = {0};  // Changes between consecutive readings
+    int32_t deltaSum[3] = {0};         // Running sums over deltaHistory, kept in step with it
+    int64_t deltaSumSquares[3] = {0};
+    bool distanceStuck = false;        // Verdict from the last update()
     size_t historyIndex = 0;
     unsigned long lastUpdate = 0;
     unsigned long lastBackupTime = 0;  // When the last backup completed
@@ -23,6 +26,12 @@ private:
     
     float getSpeedDependentThreshold() const;
 
+    // Threshold falls linearly from HIGH at standstill to LOW at full PWM on both wheels
+    static constexpr float MAX_PWM_SUM = 2.0f * ((1 << MOTOR_PWM_RESOLUTION) - 1);
+    static constexpr float THRESHOLD_PER_PWM =
+        (STUCK_MIN_STDDEV_HIGH_SPEED - STUCK_MIN_STDDEV_LOW_SPEED) / MAX_PWM_SUM;
+    static constexpr float STOPPED_PWM_SUM = 0.01f * MAX_PWM_SUM;  // Below 1% counts as stopped
+
 public:
     StuckDetector(Motor& left, Motor& right, DistanceSensors& sens)
         : leftMotor(left), rightMotor(right), sensors(sens) {}
@@ -0,0 +1,115 @@
+#pragma once
+
+// Floor-dependent tuning. Each profile is a constexpr struct, the build picks one
+// with -DTUNING_PROFILE=<name> (see the envs in platformio.ini) and config.h maps
+// its fields onto the usual macros, so every use still folds to a constant.
+// Field names carry the unit, the range checks at the end of config.h run at
+// compile time. Profiles use designated initializers (GNU extension before C++20,
+// fields in declaration order) so two same-typed values can't swap unnoticed.
+struct TuningProfile {
+    const char* name;
+
+    // Steering PID, ratio error in, ratio correction out
+    float steeringKp;
+    float steeringKi;
+    float steeringKd;
+    float steeringIntegralLimit;
+
+    // Wheel velocity control
+    float wheelFfOffsetPercent;   // PWM percent where the wheel starts turning
+    float wheelFfPercentPerMmS;   // PWM percent per mm/s above that
+    float wheelKp;                // PWM percent per mm/s of error
+    float wheelKi;                // PWM percent per mm of accumulated error
+    float wheelKd;
+    float wheelIntegralLimitPercent;
+
+    // Sensor timing
+    int sensorReadTimeoutMs;      // Echo wait, covers the round trip at MAX_SENSOR_DISTANCE
+    int sensorCycleMs;            // Minimum time between triggers (round-robin)
+    int sensorFrameGapMs;         // Quiet time between concurrent frames
+
+    // Stuck detection
+    float stuckMinStddevLowSpeed;   // Delta stddev threshold (mm) at full speed
+    float stuckMinStddevHighSpeed;  // ...and at standstill
+    int stuckEncoderMs;             // No edges on either wheel for this long
+    int stuckBackupMinMs;
+    int stuckBackupMaxMs;
+    int stuckBackupSpeedPercent;
+    int stuckBackupCooldownMs;
+
+    // Speed curve, see NavigationCurves.h
+    int speedThresholdMm;         // Sigmoid midpoint
+    float speedSigmoidSlope;      // Per mm, higher = sharper
+    int minSpeedPercent;
+    int maxSpeedPercent;
+};
+
+namespace TuningProfiles {
+
+// Hard floors, what the robot was tuned on originally
+inline constexpr TuningProfile tile = {
+    .name = "tile",
+    .steeringKp = 1.0f,
+    .steeringKi = 0.05f,
+    .steeringKd = 0.2f,
+    .steeringIntegralLimit = 1.0f,
+    .wheelFfOffsetPercent = 15.0f,
+    .wheelFfPercentPerMmS = 0.19f,
+    .wheelKp = 0.1f,
+    .wheelKi = 0.5f,
+    .wheelKd = 0.0f,
+    .wheelIntegralLimitPercent = 30.0f,
+    .sensorReadTimeoutMs = 8,
+    .sensorCycleMs = 10,
+    .sensorFrameGapMs = 4,
+    .stuckMinStddevLowSpeed = 15.0f,
+    .stuckMinStddevHighSpeed = 45.0f,
+    .stuckEncoderMs = 500,
+    .stuckBackupMinMs = 1000,
+    .stuckBackupMaxMs = 2000,
+    .stuckBackupSpeedPercent = 60,
+    .stuckBackupCooldownMs = 3000,
+    .speedThresholdMm = 500,
+    .speedSigmoidSlope = 0.12f,
+    .minSpeedPercent = 40,
+    .maxSpeedPercent = 100,
+};
+
+// More rolling resistance: more PWM to get going, slower to reach speed,
+// wheels stall sooner, so stuck detection and backups get more slack.
+// Starting points, retune on the actual floor.
+inline constexpr TuningProfile carpet = {
+    .name = "carpet",
+    .steeringKp = 1.2f,
+    .steeringKi = 0.08f,
+    .steeringKd = 0.2f,
+    .steeringIntegralLimit = 1.0f,
+    .wheelFfOffsetPercent = 22.0f,
+    .wheelFfPercentPerMmS = 0.19f,
+    .wheelKp = 0.12f,
+    .wheelKi = 0.7f,
+    .wheelKd = 0.0f,
+    .wheelIntegralLimitPercent = 40.0f,
+    .sensorReadTimeoutMs = 8,
+    .sensorCycleMs = 10,
+    .sensorFrameGapMs = 4,
+    .stuckMinStddevLowSpeed = 12.0f,
+    .stuckMinStddevHighSpeed = 45.0f,
+    .stuckEncoderMs = 700,
+    .stuckBackupMinMs = 1200,
+    .stuckBackupMaxMs = 2200,
+    .stuckBackupSpeedPercent = 70,
+    .stuckBackupCooldownMs = 3000,
+    .speedThresholdMm = 550,
+    .speedSigmoidSlope = 0.12f,
+    .minSpeedPercent = 45,
+    .maxSpeedPercent = 100,
+};
+
+}  // namespace TuningProfiles
+
+#ifndef TUNING_PROFILE
+#define TUNING_PROFILE tile
+#endif
+
+inline constexpr const TuningProfile& ACTIVE_TUNING = TuningProfiles::TUNING_PROFILE;
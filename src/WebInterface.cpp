@@ -1,4 +1,5 @@
 #include "WebInterface.h"
+#include "Profiler.h"
 
 void WebInterface::begin() {
     // Serve root page with auto-escaped HTML template
@@ -274,10 +275,33 @@ void WebInterface::begin() {
             }
             document.getElementById("calibrationStatus").textContent = "Calibrating...";
             fetch("/motors/calibrate")
+                .then(response => {
+                    if (response.status === 409) throw new Error("Calibration already running");
+                    if (!response.ok) throw new Error("Calibration failed!");
+                    // Give the control task a tick to pick up the command
+                    setTimeout(pollCalibration, 250);
+                })
+                .catch(error => {
+                    document.getElementById("calibrationStatus").textContent = error.message;
+                });
+        }
+
+        function pollCalibration() {
+            fetch("/motors/calibrate/status")
                 .then(response => response.json())
                 .then(data => {
-                    document.getElementById("calibrationStatus").textContent = 
-                        `Calibration complete - Left scale: ${data.left}, Right scale: ${data.right}`;
+                    const status = document.getElementById("calibrationStatus");
+                    if (data.status === "running") {
+                        status.textContent = `Calibrating... ${data.progress}%`;
+                        setTimeout(pollCalibration, 250);
+                    } else if (data.status === "done") {
+                        status.textContent = 
+                            `Calibration complete - Left scale: ${data.left}, Right scale: ${data.right}`;
+                    } else if (data.status === "rejected") {
+                        status.textContent = "Calibration rejected - motors off or busy";
+                    } else {
+                        status.textContent = "Calibration failed!";
+                    }
                 })
                 .catch(error => {
                     document.getElementById("calibrationStatus").textContent = "Calibration failed!";
@@ -309,50 +333,181 @@ void WebInterface::begin() {
     });
 
     server.on("/status", HTTP_GET, [this]() {
-        const char* mode;
-        switch(robotState.getMode()) {
-            case OperationMode::Off: mode = "OFF"; break;
-            case OperationMode::Manual: mode = "MANUAL"; break;
-            case OperationMode::Auto: mode = "AUTO"; break;
-        }
-        server.send(200, "text/plain", mode);
+        server.send(200, "text/plain", modeName(link.readTelemetry().mode));
     });
 
     server.on("/toggle", HTTP_GET, [this]() {
         // Cycle through states: OFF -> MANUAL -> AUTO -> OFF
-        switch(robotState.getMode()) {
-            case OperationMode::Off:
-                robotState.setMode(OperationMode::Manual);
-                break;
-            case OperationMode::Manual:
-                robotState.setMode(OperationMode::Auto);
-                break;
-            case OperationMode::Auto:
-                robotState.setMode(OperationMode::Off);
-                break;
-        }
-        motors.stop();
-        server.send(200, "text/plain", 
-            robotState.isOff() ? "OFF" : 
-            robotState.isManual() ? "MANUAL" : "AUTO");
+        OperationMode next;
+        switch(link.readTelemetry().mode) {
+            case OperationMode::Off: next = OperationMode::Manual; break;
+            case OperationMode::Manual: next = OperationMode::Auto; break;
+            default: next = OperationMode::Off; break;
+        }
+        sendMode(next);
     });
 
     server.on("/motors/test", HTTP_GET, [this]() {
-        motors.test();
+        sendCommand(CommandType::TestMotors);
         server.send(200, "text/plain", "Running test sequence");
     });
 
     server.on("/distance", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
+        String json = "{";
+        json += "\"front\":" + String(t.frontDistance) + ",";
+        json += "\"left\":" + String(t.leftDistance) + ",";
+        json += "\"right\":" + String(t.rightDistance) + ",";
+        json += "\"latencyUs\":{";
+        json += "\"front\":" + String(t.captureLatencyUs[FRONT_SENSOR]) + ",";
+        json += "\"left\":" + String(t.captureLatencyUs[LEFT_SENSOR]) + ",";
+        json += "\"right\":" + String(t.captureLatencyUs[RIGHT_SENSOR]);
+        json += "},\"raw\":{";
+        json += "\"front\":" + String(t.rawDistance[FRONT_SENSOR]) + ",";
+        json += "\"left\":" + String(t.rawDistance[LEFT_SENSOR]) + ",";
+        json += "\"right\":" + String(t.rawDistance[RIGHT_SENSOR]);
+        json += "},\"confidence\":{";
+        json += "\"front\":" + String(t.sensorConfidence[FRONT_SENSOR]) + ",";
+        json += "\"left\":" + String(t.sensorConfidence[LEFT_SENSOR]) + ",";
+        json += "\"right\":" + String(t.sensorConfidence[RIGHT_SENSOR]);
+        json += "},\"ageMs\":{";
+        json += "\"front\":" + String(t.sensorAgeMs[FRONT_SENSOR]) + ",";
+        json += "\"left\":" + String(t.sensorAgeMs[LEFT_SENSOR]) + ",";
+        json += "\"right\":" + String(t.sensorAgeMs[RIGHT_SENSOR]);
+        json += "}}";
+        server.send(200, "application/json", json);
+    });
+
+    // Ranging measurement: achieved frame rate, per-sensor refresh and rejections
+    server.on("/sensors/stats", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
         String json = "{";
-        json += "\"front\":" + String(sensors.getFrontDistance()) + ",";
-        json += "\"left\":" + String(sensors.getLeftDistance()) + ",";
-        json += "\"right\":" + String(sensors.getRightDistance());
+        json += "\"mode\":\"" + String(t.rangingMode == RangingMode::Concurrent ? "concurrent" : "sequential") + "\",";
+        json += "\"frameRate\":" + String(t.sensorFrameRate) + ",";
+        json += "\"frames\":" + String(t.sensorFrames) + ",";
+        json += "\"crosstalkRejections\":" + String(t.crosstalkRejections) + ",";
+        json += "\"outlierRejections\":" + String(t.outlierRejections) + ",";
+        json += "\"schedule\":\"" + String(t.scheduleName) + "\",";
+        json += "\"refreshHz\":{";
+        json += "\"front\":" + String(t.refreshRateHz[FRONT_SENSOR]) + ",";
+        json += "\"left\":" + String(t.refreshRateHz[LEFT_SENSOR]) + ",";
+        json += "\"right\":" + String(t.refreshRateHz[RIGHT_SENSOR]);
+        json += "}";
         json += "}";
         server.send(200, "application/json", json);
     });
 
+    // Dead-reckoned pose since boot or the last reset, mm and degrees
+    server.on("/odometry", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
+        String json = "{";
+        json += "\"x\":" + String(t.pose.x, 1) + ",";
+        json += "\"y\":" + String(t.pose.y, 1) + ",";
+        json += "\"theta\":" + String(t.pose.theta * RAD_TO_DEG, 1) + ",";
+        json += "\"linear\":" + String(t.linearVelocity, 1) + ",";
+        json += "\"angular\":" + String(t.angularVelocity * RAD_TO_DEG, 1) + ",";
+        json += "\"distance\":" + String(t.odometryDistance, 0);
+        json += "}";
+        server.send(200, "application/json", json);
+    });
+
+    server.on("/odometry/reset", HTTP_GET, [this]() {
+        sendCommand(CommandType::ResetOdometry);
+        server.send(200, "text/plain", "Odometry reset");
+    });
+
+    // Which strategy drives in AUTO, what the VFH currently sees and what the speed governor does
+    server.on("/navigation", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
+        String json = "{";
+        json += "\"strategy\":\"" + String(t.navigationName) + "\",";
+        json += "\"vfhDirection\":" + String(t.vfhDirection * RAD_TO_DEG, 0) + ",";
+        json += "\"vfhPoints\":" + String(t.vfhPoints) + ",";
+        json += "\"gridReadings\":" + String(t.gridReadings) + ",";
+        json += "\"governor\":{";
+        json += "\"state\":\"" + String(t.governorState) + "\",";
+        json += "\"ttcMs\":" + String(t.ttcMs) + ",";
+        json += "\"closing\":{";
+        json += "\"left\":" + String(t.closing[LEFT_SENSOR], 0) + ",";
+        json += "\"right\":" + String(t.closing[RIGHT_SENSOR], 0) + ",";
+        json += "\"front\":" + String(t.closing[FRONT_SENSOR], 0);
+        json += "},";
+        json += "\"sensor\":" + String(t.governorSensor) + ",";
+        json += "\"capPercent\":" + String(t.governorCapPercent);
+        json += "}}";
+        server.send(200, "application/json", json);
+    });
+
+    // Occupancy grid as a binary blob, layout in navigation/OccupancyGrid.h
+    server.on("/navigation/grid", HTTP_GET, [this]() {
+        static uint8_t blob[OccupancyGrid::BLOB_BYTES];  // Off the network task's stack
+        if (!link.readGrid(blob)) {
+            server.send(503, "text/plain", "Grid not published yet");
+            return;
+        }
+        server.setContentLength(sizeof(blob));
+        server.send(200, "application/octet-stream", "");
+        server.sendContent((const char*)blob, sizeof(blob));
+    });
+
+    server.on("/navigation/strategy", HTTP_GET, [this]() {
+        String value = server.arg("value");
+        RobotCommand command;
+        command.type = CommandType::SetNavigationMode;
+        if (value == "reactive") {
+            command.navigation = NavigationMode::Reactive;
+        } else if (value == "vfh") {
+            command.navigation = NavigationMode::Vfh;
+        } else {
+            server.send(400, "text/plain", "Expected value=reactive or value=vfh");
+            return;
+        }
+        if (!link.sendCommand(command)) {
+            server.send(503, "text/plain", "Command queue full");
+            return;
+        }
+        server.send(200, "text/plain", value);
+    });
+
+    server.on("/navigation/governor", HTTP_GET, [this]() {
+        String value = server.arg("value");
+        float enabled;
+        if (value == "on") {
+            enabled = 1;
+        } else if (value == "off") {
+            enabled = 0;
+        } else {
+            server.send(400, "text/plain", "Expected value=on or value=off");
+            return;
+        }
+        if (!sendCommand(CommandType::SetSpeedGovernor, enabled)) {
+            server.send(503, "text/plain", "Command queue full");
+            return;
+        }
+        server.send(200, "text/plain", value);
+    });
+
+    server.on("/sensors/mode", HTTP_GET, [this]() {
+        String value = server.arg("value");
+        RobotCommand command;
+        command.type = CommandType::SetRangingMode;
+        if (value == "concurrent") {
+            command.ranging = RangingMode::Concurrent;
+        } else if (value == "sequential") {
+            command.ranging = RangingMode::Sequential;
+        } else {
+            server.send(400, "text/plain", "Expected value=concurrent or value=sequential");
+            return;
+        }
+        if (!link.sendCommand(command)) {
+            server.send(503, "text/plain", "Command queue full");
+            return;
+        }
+        server.send(200, "text/plain", value);
+    });
+
     server.on("/motors/speed", HTTP_GET, [this]() {
-        if (!robotState.isManual()) {
+        if (link.readTelemetry().mode != OperationMode::Manual) {
             server.send(400, "text/plain", "Must be in manual mode");
             return;
         }
@@ -360,8 +515,7 @@ void WebInterface::begin() {
         if(server.hasArg("value")) {
             float speed = server.arg("value").toFloat();
             if (speed >= -100 && speed <= 100) {
-                robotState.resetActivityTimer();  // Reset inactivity timer
-                motors.setSpeedPercent(speed);
+                sendCommand(CommandType::SetSpeed, speed);
                 server.send(200, "text/plain", "OK");
             } else {
                 server.send(400, "text/plain", "Invalid speed value");
@@ -370,7 +524,7 @@ void WebInterface::begin() {
     });
 
     server.on("/motors/steering", HTTP_GET, [this]() {
-        if (!robotState.isManual()) {
+        if (link.readTelemetry().mode != OperationMode::Manual) {
             server.send(400, "text/plain", "Must be in manual mode");
             return;
         }
@@ -378,8 +532,7 @@ void WebInterface::begin() {
         if(server.hasArg("value")) {
             float steering = server.arg("value").toFloat();
             if (steering >= -1.0f && steering <= 1.0f) {
-                robotState.resetActivityTimer();  // Reset inactivity timer
-                motors.setSteering(steering);
+                sendCommand(CommandType::SetSteering, steering);
                 server.send(200, "text/plain", "OK");
             } else {
                 server.send(400, "text/plain", "Invalid steering value");
@@ -387,32 +540,86 @@ void WebInterface::begin() {
         }
     });
 
+    server.on("/motors/mode", HTTP_GET, [this]() {
+        String value = server.arg("value");
+        RobotCommand command;
+        command.type = CommandType::SetDriveMode;
+        if (value == "velocity") {
+            command.drive = DriveMode::Velocity;
+        } else if (value == "openloop") {
+            command.drive = DriveMode::OpenLoop;
+        } else {
+            server.send(400, "text/plain", "Expected value=velocity or value=openloop");
+            return;
+        }
+        if (!link.sendCommand(command)) {
+            server.send(503, "text/plain", "Command queue full");
+            return;
+        }
+        server.send(200, "text/plain", value);
+    });
+
+    // Acceleration limiting of the motor PWM, stops from the stop button stay immediate
+    server.on("/motors/slew", HTTP_GET, [this]() {
+        String value = server.arg("value");
+        RobotCommand command;
+        command.type = CommandType::SetSlewProfile;
+        if (value == "off") {
+            command.slew = SlewProfile::Off;
+        } else if (value == "smooth") {
+            command.slew = SlewProfile::Smooth;
+        } else if (value == "fast") {
+            command.slew = SlewProfile::Fast;
+        } else {
+            server.send(400, "text/plain", "Expected value=off, value=smooth or value=fast");
+            return;
+        }
+        if (!link.sendCommand(command)) {
+            server.send(503, "text/plain", "Command queue full");
+            return;
+        }
+        server.send(200, "text/plain", value);
+    });
+
+    // Wheel speeds in mm/s, targets are 0 in open loop
+    server.on("/motors/speeds", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
+        String json = "{";
+        json += "\"mode\":\"" + String(t.driveMode == DriveMode::Velocity ? "velocity" : "openloop") + "\",";
+        json += "\"left\":" + String(t.leftSpeed, 1) + ",";
+        json += "\"right\":" + String(t.rightSpeed, 1) + ",";
+        json += "\"leftTarget\":" + String(t.leftTargetSpeed, 1) + ",";
+        json += "\"rightTarget\":" + String(t.rightTargetSpeed, 1) + ",";
+        const char* slew = t.slewProfile == SlewProfile::Off ? "off" : t.slewProfile == SlewProfile::Fast ? "fast" : "smooth";
+        json += "\"slew\":\"" + String(slew) + "\",";
+        json += "\"faults\":" + String(t.motorFaults);
+        json += "}";
+        server.send(200, "application/json", json);
+    });
+
     server.on("/motors/stop", HTTP_GET, [this]() {
-        motors.stop();
+        sendCommand(CommandType::Stop);
         server.send(200, "text/plain", "Motors stopped");
     });
 
     // Update motors/status endpoint to just return basic status:
     server.on("/motors/status", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
         String status = "Stopped";
-        if (leftMotor.getCurrentSpeed() != 0 || rightMotor.getCurrentSpeed() != 0) {
+        if (t.leftSpeed != 0 || t.rightSpeed != 0) {
             status = "Running";
         }
         server.send(200, "text/plain", status);
     });
 
     server.on("/mode/toggle", HTTP_GET, [this]() {
-        if (robotState.isAuto()) {
-            robotState.setMode(OperationMode::Manual);
-        } else if (robotState.isManual()) {
-            robotState.setMode(OperationMode::Off);
-        } else {
-            robotState.setMode(OperationMode::Auto);
+        OperationMode next;
+        switch(link.readTelemetry().mode) {
+            case OperationMode::Auto: next = OperationMode::Manual; break;
+            case OperationMode::Manual: next = OperationMode::Off; break;
+            default: next = OperationMode::Auto; break;
         }
-        motors.stop();
-        server.send(200, "text/plain", 
-            robotState.isOff() ? "OFF" : 
-            robotState.isManual() ? "MANUAL" : "AUTO");
+        sendMode(next);
     });
 
     server.on("/log", HTTP_GET, [this]() {
@@ -421,50 +628,159 @@ void WebInterface::begin() {
 
     // Update endpoint to handle mode changes
     server.on("/mode/OFF", HTTP_GET, [this]() {
-        robotState.setMode(OperationMode::Off);
-        motors.stop();
-        server.send(200, "text/plain", "OFF");
+        sendMode(OperationMode::Off);
     });
 
     server.on("/mode/MANUAL", HTTP_GET, [this]() {
-        robotState.setMode(OperationMode::Manual);
-        robotState.resetActivityTimer();  // Reset inactivity timer
-        motors.stop();
-        server.send(200, "text/plain", "MANUAL");
+        sendMode(OperationMode::Manual);
     });
 
     server.on("/mode/AUTO", HTTP_GET, [this]() {
-        robotState.setMode(OperationMode::Auto);
-        robot.resetStuckDetection(); // Reset stuck detection when switching to auto
-        motors.stop();
-        server.send(200, "text/plain", "AUTO");
+        sendMode(OperationMode::Auto);
     });
 
-    // Add calibration endpoint
+    // Add calibration endpoint, returns at once, progress via /motors/calibrate/status
     server.on("/motors/calibrate", HTTP_GET, [this]() {
-        if (!robotState.isManual()) {
+        RobotTelemetry t = link.readTelemetry();
+        if (t.mode != OperationMode::Manual) {
             server.send(400, "text/plain", "Must be in manual mode");
             return;
         }
-        motors.calibrate();
+        if (t.calibrationStatus == CalibrationStatus::Running) {
+            server.send(409, "text/plain", "Calibration already running");
+            return;
+        }
+        if (!sendCommand(CommandType::Calibrate)) {
+            server.send(503, "text/plain", "Command queue full");
+            return;
+        }
+        server.send(202, "application/json", "{\"status\":\"started\"}");
+    });
+
+    server.on("/motors/calibrate/status", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
+        const char* status;
+        switch(t.calibrationStatus) {
+            case CalibrationStatus::Running: status = "running"; break;
+            case CalibrationStatus::Done: status = "done"; break;
+            case CalibrationStatus::Failed: status = "failed"; break;
+            case CalibrationStatus::Rejected: status = "rejected"; break;
+            default: status = "idle"; break;
+        }
         String json = "{";
-        json += "\"left\":" + String(motors.getLeftScale()) + ",";
-        json += "\"right\":" + String(motors.getRightScale());
+        json += "\"status\":\"" + String(status) + "\",";
+        json += "\"progress\":" + String(t.calibrationProgress) + ",";
+        json += "\"left\":" + String(t.leftScale) + ",";
+        json += "\"right\":" + String(t.rightScale) + ",";
+        json += "\"stored\":" + String(t.calibrationStored ? "true" : "false");
+        json += "}";
+        server.send(200, "application/json", json);
+    });
+
+    server.on("/motors/calibrate/clear", HTTP_GET, [this]() {
+        if (!sendCommand(CommandType::ClearCalibration)) {
+            server.send(503, "text/plain", "Command queue full");
+            return;
+        }
+        server.send(200, "text/plain", "Calibration cleared");
+    });
+
+    // Measured PWM percent -> mm/s points per wheel, empty before calibration
+    server.on("/motors/curve", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
+        auto points = [](const SpeedCurve& curve) {
+            String json = "[";
+            for (size_t i = 0; i < curve.size(); i++) {
+                if (i > 0) json += ",";
+                json += "[" + String(curve.getPwmPercent(i), 1) + "," + String(curve.getSpeed(i), 1) + "]";
+            }
+            return json + "]";
+        };
+        String json = "{";
+        json += "\"left\":" + points(t.leftCurve) + ",";
+        json += "\"right\":" + points(t.rightCurve);
         json += "}";
         server.send(200, "application/json", json);
     });
 
     // Add new endpoint before the final curly brace
     server.on("/status/stuck", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
         String json = "{";
-        json += "\"stuck\":" + String(robot.isStuck() ? "true" : "false") + ",";
-        json += "\"backupRemaining\":" + String(robot.getBackupTimeRemaining());
+        json += "\"stuck\":" + String(t.stuck ? "true" : "false") + ",";
+        json += "\"backupRemaining\":" + String(t.backupRemaining);
         json += "}";
         server.send(200, "application/json", json);
     });
 
+    server.on("/status/timing", HTTP_GET, [this]() {
+        RobotTelemetry t = link.readTelemetry();
+        String json = "{";
+        json += "\"tickUs\":" + String(CONTROL_TICK_US) + ",";
+        json += "\"tickOverruns\":" + String(t.tickOverruns) + ",";
+        json += "\"tickMissed\":" + String(t.tickMissed) + ",";
+        json += "\"pidIntervalUs\":" + String(STEERING_PID_INTERVAL_US) + ",";
+        json += "\"pidDtUs\":" + String(t.pidDtUs) + ",";
+        json += "\"pidMissed\":" + String(t.pidMissed) + ",";
+        json += "\"pwmSkipped\":" + String(t.pwmSkipped);
+        json += "}";
+        server.send(200, "application/json", json);
+    });
+
+#if ENABLE_PROFILER
+    // Profiler is lock-protected, so it is read directly rather than via telemetry
+    server.on("/metrics", HTTP_GET, [this]() {
+        String json = "{";
+        json += "\"cpuMhz\":" + String(getCpuFrequencyMhz()) + ",";
+        json += "\"stages\":{";
+        for (size_t i = 0; i < LoopProfiler::STAGES; i++) {
+            ProfileStage stage = static_cast<ProfileStage>(i);
+            LoopProfiler::StageStats stats = profiler.getStats(stage);
+            if (i > 0) json += ",";
+            json += "\"" + String(LoopProfiler::stageName(stage)) + "\":{";
+            json += "\"count\":" + String(stats.count) + ",";
+            json += "\"min\":" + String(stats.min) + ",";
+            json += "\"max\":" + String(stats.max) + ",";
+            json += "\"p50\":" + String(stats.p50) + ",";
+            json += "\"p99\":" + String(stats.p99);
+            json += "}";
+        }
+        json += "}}";
+        if (server.hasArg("reset")) {
+            profiler.reset();
+        }
+        server.send(200, "application/json", json);
+    });
+#endif
+
     server.on("/motors/test_backup", HTTP_GET, [this]() {
-        robot.testBackup();
+        sendCommand(CommandType::TestBackup);
         server.send(200, "text/plain", "Running backup test");
     });
 }
+
+bool WebInterface::sendCommand(CommandType type, float value) {
+    RobotCommand command;
+    command.type = type;
+    command.value = value;
+    return link.sendCommand(command);
+}
+
+void WebInterface::sendMode(OperationMode mode) {
+    RobotCommand command;
+    command.type = CommandType::SetMode;
+    command.mode = mode;
+    if (!link.sendCommand(command)) {
+        server.send(503, "text/plain", "Command queue full");
+        return;
+    }
+    server.send(200, "text/plain", modeName(mode));
+}
+
+const char* WebInterface::modeName(OperationMode mode) {
+    switch(mode) {
+        case OperationMode::Manual: return "MANUAL";
+        case OperationMode::Auto: return "AUTO";
+        default: return "OFF";
+    }
+}
@@ -1,28 +1,23 @@
 #pragma once
 #include <WebServer.h>
-#include "RobotLogic.h"
-#include "MotorController.h"
-#include "DistanceSensors.h"
+#include "ControlLink.h"
 #include "loggers/WebLogger.h"
 
+// Runs on the network task. All robot access goes through ControlLink:
+// requests are posted as commands, responses are built from telemetry.
 class WebInterface {
 private:
     WebServer& server;
-    RobotLogic& robot;
-    MotorController& motors;
-    Motor& leftMotor;
-    Motor& rightMotor;
-    DistanceSensors& sensors;
+    ControlLink& link;
     WebLogger& webLogger;
-    RobotState& robotState;  // Add reference to shared state
+
+    bool sendCommand(CommandType type, float value = 0);
+    void sendMode(OperationMode mode);
+    static const char* modeName(OperationMode mode);
 
 public:
-    WebInterface(WebServer& srv, RobotLogic& r, MotorController& m, 
-                Motor& left, Motor& right, DistanceSensors& s, WebLogger& wl,
-                RobotState& rs)  // Add RobotState to constructor
-        : server(srv), robot(r), motors(m), 
-          leftMotor(left), rightMotor(right), sensors(s), webLogger(wl),
-          robotState(rs) {}
+    WebInterface(WebServer& srv, ControlLink& l, WebLogger& wl)
+        : server(srv), link(l), webLogger(wl) {}
 
     void begin();
     void handle() { server.handleClient(); }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include "TuningProfile.h"
 
 // Motor pins
 #define LEFT_MOTOR_IN1 GPIO_NUM_16
@@ -16,6 +17,15 @@
 #define ENCODER_LEFT GPIO_NUM_15
 #define ENCODER_RIGHT GPIO_NUM_21
 
+// Encoder counting: 1 = PCNT hardware counter, 0 = GPIO interrupt per edge
+#ifndef ENCODER_BACKEND_PCNT
+#define ENCODER_BACKEND_PCNT 1
+#endif
+#define ENCODER_GLITCH_FILTER 1000  // PCNT filter in APB cycles (12.5us), max 1023
+#define ENCODER_EDGES_PER_MM 5.0f   // Counted edges per mm of wheel travel
+#define ODOMETRY_WHEEL_BASE_MM 140.0f  // Distance between the wheel contact points
+#define ODOMETRY_LOG_INTERVAL 2000  // Pose debug log period (ms), 0 = off
+
 // HC-SR04 pins
 #define LEFT_ECHO_PIN GPIO_NUM_13
 #define LEFT_TRIG_PIN GPIO_NUM_14
@@ -26,22 +36,104 @@
 
 // Basic configuration
 #define NUM_SENSORS 3
-#define SENSOR_READ_TIMEOUT 8      // 8ms timeout for 1.3m max range
-#define SENSOR_CYCLE_TIME 10      // Minimum time between sensor triggers (ms)
+#define SENSOR_READ_TIMEOUT ACTIVE_TUNING.sensorReadTimeoutMs  // Echo wait (ms)
+#define SENSOR_CYCLE_TIME ACTIVE_TUNING.sensorCycleMs  // Minimum time between sensor triggers (ms)
 #define MAX_SENSOR_DISTANCE 1300   // Maximum detection range in mm
 #define MIN_FRONT_STEERING 0.3f    // Minimum steering correction when obstacle in front
 
+// Echo capture: 1 = MCPWM hardware capture, 0 = HC_SR04 library (GPIO interrupts)
+#ifndef SENSOR_BACKEND_MCPWM
+#define SENSOR_BACKEND_MCPWM 1
+#endif
+
+// Concurrent ranging: side sensors fire together, front follows after a stagger
+#define SENSOR_RANGING_CONCURRENT true  // false = legacy round-robin, one sensor at a time
+#define SENSOR_STAGGER_US 2000          // Front trigger offset after the side pair (us)
+#define SENSOR_STAGGER_JITTER_US 1000   // Added every other frame, moves stray echoes by ~170mm
+#define SENSOR_FRAME_GAP ACTIVE_TUNING.sensorFrameGapMs  // Quiet time between frames for stray echoes (ms)
+#define CROSSTALK_WINDOW_MM 60          // Reading this close to another sensor's ping arrival is suspect
+#define CROSSTALK_MAX_JUMP_MM 200       // ...and only rejected if it jumps this far from the last reading
+
+// Per-sensor filter, runs on every raw reading (see sensors/RangeFilter.h)
+#define SENSOR_MEDIAN_WINDOW 3          // Samples in the running median, 1 = off (max 5)
+#define SENSOR_MAX_RATE_MM_S 1500       // Faster changes are gated as outliers, 0 = off
+#define SENSOR_GATE_MARGIN_MM 50        // Slack on top of the rate limit
+#define SENSOR_GATE_CONFIRM 2           // Consistent outliers in a row taken as a real step
+#define SENSOR_NO_ECHO_LIMIT 3          // Missing echoes in a row before reporting MAX_SENSOR_DISTANCE
+#define SENSOR_KALMAN false             // 1D Kalman on top of the median
+#define SENSOR_KALMAN_Q 250000.0f       // Process noise, variance growth per second (mm^2/s)
+#define SENSOR_KALMAN_R 400.0f          // Measurement noise variance (mm^2)
+
+// Sensor scheduling, which sensors fire each frame (see sensors/SchedulePolicy.h)
+#define SCHED_ADAPTIVE true             // false = every sensor every frame at full range
+#define SCHED_CRUISE_SPEED 70           // Speed percent from which sides only fire every third frame
+#define SCHED_SIDES_STEERING 0.4f       // |steering| above this fires the sides every frame
+#define SCHED_CLOSING_MM_S 200          // Front closing faster than this favours the front
+#define SCHED_MIN_FRONT_RANGE 600       // Front range needed at standstill (mm), full range at 100%
+
+// Latency compensation, see DistanceSensors::predictDistance()
+#define SENSOR_SAMPLE_RING 8            // Timestamped samples kept per sensor
+#define SENSOR_PREDICT_WINDOW_MS 100    // Samples used for the slope fit
+#define SENSOR_PREDICT_MAX_RESIDUAL 8.0f // Worse fits (RMS mm) aren't extrapolated
+#define SENSOR_PREDICT_MAX_AGE_MS 60    // Never extrapolate further than this
+#define SENSOR_PREDICT_ODOMETRY_WEIGHT 0.5f  // Front only: odometry closing rate vs fitted slope
+#define SENSOR_CLOSING_SMOOTHING 0.2f   // Low-pass on the per-sensor closing rate, 1 = raw
+
 // Speed control
-#define SPEED_THRESHOLD_MM 500     // Midpoint for speed transition sigmoid
-#define SPEED_SIGMOID_SLOPE 0.12f  // Slope parameter for sigmoid function (higher = sharper transition)
+#define SPEED_THRESHOLD_MM ACTIVE_TUNING.speedThresholdMm    // Midpoint for speed transition sigmoid
+#define SPEED_SIGMOID_SLOPE ACTIVE_TUNING.speedSigmoidSlope  // Slope parameter for sigmoid function (higher = sharper transition)
 // Wolfram Alpha expression: plot 40 + 60/(1 + exp(-0.01*(x-600))) for x=0 to 1300
-#define MIN_SPEED_PERCENT 40       // Minimum speed when close to obstacles
-#define MAX_SPEED_PERCENT 100      // Maximum speed when path is clear
+#define MIN_SPEED_PERCENT ACTIVE_TUNING.minSpeedPercent  // Minimum speed when close to obstacles
+#define MAX_SPEED_PERCENT ACTIVE_TUNING.maxSpeedPercent  // Maximum speed when path is clear
+#define NAV_CURVE_STEP_MM 4        // Distance step of the speed/steering lookup tables
+
+// Navigation strategy (see navigation/NavigationStrategy.h), switchable at runtime
+#define NAV_VFH false                   // true = vector field histogram, false = reactive formula
+#define NAV_FRONT_SENSOR_FORWARD_MM 70  // Front sensor ahead of the wheel axis
+#define NAV_SIDE_SENSOR_FORWARD_MM 60   // Side sensors ahead of the wheel axis...
+#define NAV_SIDE_SENSOR_LATERAL_MM 40   // ...and off the centre line
+#define NAV_SIDE_SENSOR_ANGLE 0.785f    // ...looking this far off the heading (rad)
+#define VFH_MEMORY_POINTS 64            // Obstacle points remembered, oldest dropped first
+#define VFH_MEMORY_AGE_MS 4000          // ...and forgotten after this
+#define VFH_SECTORS 36                  // Histogram sectors all around, 10 degrees each
+#define VFH_ROBOT_RADIUS_MM 130         // Robot radius plus clearance, obstacles are widened by it
+#define VFH_THRESHOLD_HIGH 0.5f         // Sector density above this is blocked...
+#define VFH_THRESHOLD_LOW 0.3f          // ...and free again below this
+#define VFH_WIDE_VALLEY 6               // Free sectors from which a valley counts as wide
+#define VFH_COST_TURN 1.0f              // Cost of a candidate's angle off the heading
+#define VFH_COST_CHANGE 2.0f            // ...and off the last chosen direction
+#define VFH_FULL_STEER_RAD 1.05f        // Direction that gets full steering (~60 degrees)
+
+// Time-to-collision speed governor on top of the strategy (see navigation/SpeedGovernor.h)
+#define GOVERNOR_ENABLED false          // Switchable at runtime, off until it stops costing impacts
+#define GOVERNOR_DECEL_MM_S2 800.0f     // Braking budget
+#define GOVERNOR_MARGIN_MM 100          // Stop this far short of the reading
+#define GOVERNOR_LATENCY_MS 100         // Sensing to slowing down, covered at the old closing rate
+#define GOVERNOR_MIN_CLOSING_MM_S 50.0f // Slower closing rates are taken as noise
+#define GOVERNOR_MIN_FORWARD_MM_S 50.0f // Slower than this the cap is skipped, slowing down can't help
+#define GOVERNOR_MIN_PERCENT 20         // Cap floor, below MIN_SPEED_PERCENT so it brakes past the distance curve
+#define GOVERNOR_CRUISE_TTC_S 3.0f      // Nothing closing in sooner than this...
+#define GOVERNOR_CRUISE_PERCENT 70      // ...lets the speed up to at least this
+#define GOVERNOR_TTC_MAX_MS 10000       // TTC reported when nothing closes in
+
+// Rolling occupancy grid around the robot (see navigation/OccupancyGrid.h)
+#define OCCUPANCY_GRID_SIZE 64          // Cells per side, power of 2
+#define OCCUPANCY_CELL_MM 50
+#define OCCUPANCY_HIT 3                 // Log-odds added to the cell an echo came from...
+#define OCCUPANCY_MISS 1                // ...and taken off each cell the beam crossed first
+#define OCCUPANCY_OCCUPIED 3            // Log-odds from which a cell counts as occupied (max 7)
+#define OCCUPANCY_DECAY_MS 4000         // Every cell steps one towards unknown this often, 0 = never
+#define OCCUPANCY_PUBLISH_INTERVAL 500  // ms between grid snapshots for the web UI
 
 // Debug configuration
 #define ENABLE_DEBUG_LOGS true    // Set to false to disable debug messages
 #define LOG_LEVEL LogLevel::Info  // Enable debug logs
 
+// Per-stage loop profiler, build with -DENABLE_PROFILER=0 to compile it out
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 1
+#endif
+
 // Define FILTERED_CONTEXTS
 #define FILTERED_CONTEXTS 0
 
@@ -51,36 +143,128 @@
 #endif
 
 // Motor control configuration
-#define MOTOR_UPDATE_INTERVAL 5    // Increased update frequency (was 50)
+#define MOTOR_UPDATE_INTERVAL 10   // Speed count window (ms), averaged over 4 windows
 #define MOTOR_PWM_RESOLUTION 10     // Increased from 8 to 10 bits for finer control
 
+// PWM output: 1 = LEDC channels owned by Motor, 0 = analogWrite
+#ifndef MOTOR_PWM_BACKEND_LEDC
+#define MOTOR_PWM_BACKEND_LEDC 1
+#endif
+#define MOTOR_PWM_FREQUENCY 20000   // LEDC backend (Hz), above hearing. Frequency << resolution must fit in 80MHz
+
+// Wheel velocity: edge periods at low speed, edge counts at high speed
+#define VELOCITY_PERIOD_EDGES 4        // Edges spanned by one period measurement
+#define VELOCITY_BLEND_LOW_MM_S 60.0f  // Pure period estimate below this
+#define VELOCITY_BLEND_HIGH_MM_S 150.0f  // Pure count estimate above this
+#define VELOCITY_MIN_MM_S 5.0f         // Slower wheels count as stopped for steering
+
 // Motor PWM control
-#define MOTOR_PWM_MIN_UPDATE_INTERVAL 10     // Reduced delay between PWM updates
-#define MOTOR_PWM_MIN_CHANGE 1              // Reduced to allow finer adjustments
+#define MOTOR_PWM_MIN_UPDATE_INTERVAL 5      // ms between small duty changes, stops and reversals always go through
+#define MOTOR_PWM_MIN_CHANGE 2              // Duty changes below this are not written
+
+// Acceleration/jerk limiting of every PWM change, emergency stops excepted (see SlewLimiter.h)
+#define MOTOR_SLEW_PROFILE 1                 // At boot: 0 = off, 1 = smooth, 2 = fast
+#define MOTOR_SLEW_SMOOTH_RATE 400.0f        // PWM percent per second
+#define MOTOR_SLEW_SMOOTH_JERK 100000.0f     // PWM percent per second^2
+#define MOTOR_SLEW_FAST_RATE 1000.0f
+#define MOTOR_SLEW_FAST_JERK 250000.0f
+#define MOTOR_SLEW_MAX_DT_US 20000           // Clamp for the ramp step after stalls
 
 // Steering PID configuration
-#define STEERING_PID_KP 1.0f    // Full opposing motor speeds at maximum error
-#define STEERING_PID_KI 0.05f    // Start without integral term
-#define STEERING_PID_KD 0.2f    // Start without derivative term
-#define STEERING_PID_INTERVAL 10   // Reduced from 10ms for faster updates
-#define STEERING_INTEGRAL_LIMIT 1.0f // Limit for integral term
+#define STEERING_PID_KP ACTIVE_TUNING.steeringKp
+#define STEERING_PID_KI ACTIVE_TUNING.steeringKi
+#define STEERING_PID_KD ACTIVE_TUNING.steeringKd
+#define STEERING_PID_INTERVAL_US 10000  // PID period in microseconds, multiple of CONTROL_TICK_US
+#define STEERING_PID_MAX_DT_US 20000    // Clamp for measured dt after stalls or restarts
+#define STEERING_INTEGRAL_LIMIT ACTIVE_TUNING.steeringIntegralLimit // Limit for integral term
+
+// Steering ratio -> PID -> PWM mixing in Q16.16 integers instead of float (see SteeringMixer.h)
+#ifndef STEERING_FIXED_POINT
+#define STEERING_FIXED_POINT 0
+#endif
+
+// Wheel velocity control: a PID per wheel on mm/s on top of a PWM feedforward.
+// Replaces open-loop PWM and the steering ratio PID when the drive mode is velocity.
+#define DRIVE_VELOCITY_CONTROL false    // Drive mode at boot, switchable at runtime
+#define WHEEL_MAX_SPEED_MM_S 400.0f     // Wheel speed at 100 percent, below what full PWM reaches
+#define WHEEL_FF_OFFSET_PERCENT ACTIVE_TUNING.wheelFfOffsetPercent
+#define WHEEL_FF_PERCENT_PER_MM_S ACTIVE_TUNING.wheelFfPercentPerMmS
+#define WHEEL_PID_KP ACTIVE_TUNING.wheelKp
+#define WHEEL_PID_KI ACTIVE_TUNING.wheelKi
+#define WHEEL_PID_KD ACTIVE_TUNING.wheelKd
+#define WHEEL_PID_INTEGRAL_LIMIT ACTIVE_TUNING.wheelIntegralLimitPercent
 
 // Motor calibration
 #define MOTOR_CALIBRATION_TIME 2000    // Time to run calibration (ms)
+#define MOTOR_CALIBRATION_SETTLE_TIME 100  // Spin-down before calibration run (ms)
+#define MOTOR_TEST_STEP_TIME 2000      // Duration of each motor test direction (ms)
 #define MOTOR_CALIBRATION_SPEED 50     // Speed percent to use for calibration
 #define DEFAULT_LEFT_MOTOR_SCALE 0.79f  // Default scaling factor
 #define DEFAULT_RIGHT_MOTOR_SCALE 1.0f // Default scaling factor
 
+// PWM -> speed curve, swept at the end of calibration and kept in NVS with the scales
+#define MOTOR_CURVE_POINTS 8           // PWM levels in the sweep
+#define MOTOR_CURVE_MIN_PWM 10.0f      // First level (percent), the rest spread evenly up to 100
+#define MOTOR_CURVE_STEP_TIME 400      // Time per level (ms)
+#define MOTOR_CURVE_SETTLE_TIME 250    // Part of each level before speeds are averaged (ms)
+
 // Stuck detector configuration
 #define STUCK_HISTORY_SIZE 40      // 1 second of readings at 50ms intervals
-#define STUCK_MIN_STDDEV_LOW_SPEED 15.0f   // Lower threshold for high speeds
-#define STUCK_MIN_STDDEV_HIGH_SPEED 45.0f  // Higher threshold for low speeds
-#define STUCK_ENCODER_TIME 500     // Time in ms before considering encoder stuck
+#define STUCK_MIN_STDDEV_LOW_SPEED ACTIVE_TUNING.stuckMinStddevLowSpeed    // Lower threshold for high speeds
+#define STUCK_MIN_STDDEV_HIGH_SPEED ACTIVE_TUNING.stuckMinStddevHighSpeed  // Higher threshold for low speeds
+#define STUCK_ENCODER_TIME ACTIVE_TUNING.stuckEncoderMs  // Time in ms before considering encoder stuck
 #define STUCK_UPDATE_INTERVAL 50   // Update interval in ms
-#define STUCK_BACKUP_MIN_TIME 1000  // Minimum backup time
-#define STUCK_BACKUP_MAX_TIME 2000  // Maximum backup time
-#define STUCK_BACKUP_SPEED 60       // Increase backup speed for more reliable movement
-#define STUCK_BACKUP_COOLDOWN 3000  // Wait at least 3 seconds before triggering another backup
+#define STUCK_BACKUP_MIN_TIME ACTIVE_TUNING.stuckBackupMinMs  // Minimum backup time
+#define STUCK_BACKUP_MAX_TIME ACTIVE_TUNING.stuckBackupMaxMs  // Maximum backup time
+#define STUCK_BACKUP_SPEED ACTIVE_TUNING.stuckBackupSpeedPercent
+#define STUCK_BACKUP_COOLDOWN ACTIVE_TUNING.stuckBackupCooldownMs  // Minimum time between backups
+#define STUCK_BACKUP_STOP_TIME 50   // Pause at standstill before reversing (ms)
 
 // Auto mode configuration
 #define AUTO_SWITCH_TIMEOUT 30000  // Time in ms to automatically switch to auto mode (30 seconds)
+
+// Task configuration
+#define CONTROL_TASK_CORE 1         // Sensing, PID and navigation run pinned here
+#define CONTROL_TASK_PRIORITY 5     // Above the network task and the Arduino loop task
+#define CONTROL_TICK_US 1000        // esp_timer period driving the control task
+#define CONTROL_TASK_STACK 8192
+#define NETWORK_TASK_CORE 0         // Same core as the WiFi stack
+#define NETWORK_TASK_PRIORITY 1     // HTTP, OTA and logging
+#define NETWORK_TASK_STACK 8192
+#define COMMAND_QUEUE_LENGTH 16     // Pending web commands waiting for the control task
+
+// Range checks on the selected tuning profile
+static_assert(ACTIVE_TUNING.steeringKp > 0 && ACTIVE_TUNING.steeringKi >= 0 && ACTIVE_TUNING.steeringKd >= 0,
+              "steering PID gains must be positive");
+static_assert(ACTIVE_TUNING.steeringIntegralLimit > 0 && ACTIVE_TUNING.steeringIntegralLimit <= 2,
+              "steering integral limit is a ratio, 0..2");
+static_assert(ACTIVE_TUNING.wheelKp > 0 && ACTIVE_TUNING.wheelKi >= 0 && ACTIVE_TUNING.wheelKd >= 0,
+              "wheel PID gains must be positive");
+static_assert(ACTIVE_TUNING.wheelFfOffsetPercent >= 0 && ACTIVE_TUNING.wheelFfOffsetPercent < 100 &&
+              ACTIVE_TUNING.wheelFfOffsetPercent + WHEEL_MAX_SPEED_MM_S * ACTIVE_TUNING.wheelFfPercentPerMmS <= 100,
+              "feedforward must stay within 100 percent PWM up to WHEEL_MAX_SPEED_MM_S");
+static_assert(ACTIVE_TUNING.wheelIntegralLimitPercent > 0 && ACTIVE_TUNING.wheelIntegralLimitPercent <= 100,
+              "wheel integral limit is PWM percent");
+// Sound covers 0.343 mm/us, the echo has to make it back before the timeout
+static_assert(ACTIVE_TUNING.sensorReadTimeoutMs * 1000 * 0.343 >= 2 * MAX_SENSOR_DISTANCE,
+              "sensor timeout too short for MAX_SENSOR_DISTANCE");
+static_assert(ACTIVE_TUNING.sensorReadTimeoutMs <= ACTIVE_TUNING.sensorCycleMs,
+              "round-robin cycle must leave time for the echo");
+static_assert(ACTIVE_TUNING.sensorFrameGapMs >= 0 && ACTIVE_TUNING.sensorFrameGapMs <= 50,
+              "frame gap out of range");
+static_assert(ACTIVE_TUNING.stuckMinStddevLowSpeed > 0 &&
+              ACTIVE_TUNING.stuckMinStddevLowSpeed <= ACTIVE_TUNING.stuckMinStddevHighSpeed,
+              "stuck stddev thresholds must be positive and rise towards standstill");
+static_assert(ACTIVE_TUNING.stuckEncoderMs > STUCK_UPDATE_INTERVAL, "encoder stall time below the stuck update interval");
+static_assert(ACTIVE_TUNING.stuckBackupMinMs > 0 && ACTIVE_TUNING.stuckBackupMinMs <= ACTIVE_TUNING.stuckBackupMaxMs,
+              "backup time range is inverted");
+static_assert(ACTIVE_TUNING.stuckBackupCooldownMs >= ACTIVE_TUNING.stuckBackupMaxMs,
+              "backup cooldown shorter than a backup");
+static_assert(ACTIVE_TUNING.stuckBackupSpeedPercent > 0 && ACTIVE_TUNING.stuckBackupSpeedPercent <= 100,
+              "backup speed is a percent");
+static_assert(ACTIVE_TUNING.speedThresholdMm > 0 && ACTIVE_TUNING.speedThresholdMm < MAX_SENSOR_DISTANCE,
+              "speed sigmoid midpoint must be inside the sensor range");
+static_assert(ACTIVE_TUNING.speedSigmoidSlope > 0, "speed sigmoid slope must be positive");
+static_assert(0 < ACTIVE_TUNING.minSpeedPercent && ACTIVE_TUNING.minSpeedPercent <= ACTIVE_TUNING.maxSpeedPercent &&
+              ACTIVE_TUNING.maxSpeedPercent <= 100,
+              "speed curve needs 0 < min <= max <= 100");
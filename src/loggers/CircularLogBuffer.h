@@ -1,31 +1,37 @@
 #pragma once
 #include <Arduino.h>
 
+// Written by the network task behind QueuedLogger, read by the web server
 class CircularLogBuffer {
     static const size_t BUFFER_SIZE = 50;  // Store last 50 messages
     String messages[BUFFER_SIZE];
     size_t writeIndex = 0;
     size_t readIndex = 0;
     bool hasWrapped = false;
+    SemaphoreHandle_t lock = xSemaphoreCreateMutex();
 
 public:
     void add(const String& message) {
+        xSemaphoreTake(lock, portMAX_DELAY);
         messages[writeIndex] = message;
         writeIndex = (writeIndex + 1) % BUFFER_SIZE;
         if (writeIndex == 0) hasWrapped = true;
+        xSemaphoreGive(lock);
     }
 
     String getAll() {
         String result;
+        xSemaphoreTake(lock, portMAX_DELAY);
         size_t start = hasWrapped ? writeIndex : 0;
         size_t count = hasWrapped ? BUFFER_SIZE : writeIndex;
-        
+
         for (size_t i = 0; i < count; i++) {
             size_t idx = (start + i) % BUFFER_SIZE;
             if (messages[idx].length() > 0) {
                 result += messages[idx] + "\n";
             }
         }
+        xSemaphoreGive(lock);
         return result;
     }
 };
@@ -0,0 +1,59 @@
+#pragma once
+#include "../Logger.h"
+
+// Hands messages from any task to whoever calls update(), so the loggers after
+// it (web buffer, LED) are only ever touched from that one task. Messages are
+// copied into fixed-size records, the caller never waits: when the queue is
+// full the message is dropped and counted.
+class QueuedLogger : public Logger {
+    static const size_t QUEUE_LENGTH = 32;   // Enough for the boot burst before the network task runs
+    static const size_t MESSAGE_LENGTH = 96; // Longer messages are truncated
+
+    struct Record {
+        LogLevel level;
+        LogContext context;
+        char message[MESSAGE_LENGTH];
+    };
+
+    QueueHandle_t queue = xQueueCreate(QUEUE_LENGTH, sizeof(Record));
+    volatile uint32_t dropped = 0;  // Senders only, update() just reads it
+    uint32_t reportedDrops = 0;
+
+    void push(LogLevel level, const String& message, LogContext context) {
+        Record record;
+        record.level = level;
+        record.context = context;
+        snprintf(record.message, sizeof(record.message), "%s", message.c_str());
+        if (!queue || xQueueSend(queue, &record, 0) != pdTRUE) {
+            dropped++;
+        }
+    }
+
+public:
+    QueuedLogger(Logger* next = nullptr) : Logger(next) {}
+
+    void error(const String& message, LogContext context) override { push(LogLevel::Error, message, context); }
+    void warning(const String& message, LogContext context) override { push(LogLevel::Warning, message, context); }
+    void info(const String& message, LogContext context) override { push(LogLevel::Info, message, context); }
+    void debug(const String& message, LogContext context) override { push(LogLevel::Debug, message, context); }
+
+    // Drains the queue into the rest of the chain, call from a single task
+    void update() override {
+        Record record;
+        while (next && queue && xQueueReceive(queue, &record, 0) == pdTRUE) {
+            String message(record.message);
+            switch (record.level) {
+                case LogLevel::Error: next->error(message, record.context); break;
+                case LogLevel::Warning: next->warning(message, record.context); break;
+                case LogLevel::Info: next->info(message, record.context); break;
+                case LogLevel::Debug: next->debug(message, record.context); break;
+            }
+        }
+        uint32_t total = dropped;
+        if (next && total != reportedDrops) {
+            next->warning(String(total - reportedDrops) + " log messages dropped", LogContext::System);
+            reportedDrops = total;
+        }
+        if (next) next->update();
+    }
+};
@@ -8,17 +8,23 @@
 #include "DistanceSensors.h"
 #include "RobotLogic.h"
 #include "WebInterface.h"
+#include "ControlLink.h"
+#include "ControlTick.h"
+#include "Profiler.h"
 #include "credentials.h"
 #include "loggers/SerialLogger.h"
 #include "loggers/WebLogger.h"
 #include "loggers/LogLevelDecorator.h"
 #include "loggers/LedLogger.h"
+#include "loggers/QueuedLogger.h"
 #include "OTAManager.h"
 
 // Create logger chain
 LedLogger* ledLogger = new LedLogger(LED_BUILTIN, nullptr);  // Fix null to nullptr
 WebLogger* webLogger = new WebLogger(ledLogger);  // Fix null to nullptr
-LogLevelDecorator* levelLogger = new LogLevelDecorator(webLogger, LOG_LEVEL, FILTERED_CONTEXTS);
+// Filtered in the caller's task, formatted and stored by the network task
+QueuedLogger* queuedLogger = new QueuedLogger(webLogger);
+LogLevelDecorator* levelLogger = new LogLevelDecorator(queuedLogger, LOG_LEVEL, FILTERED_CONTEXTS);
 
 // Create shared robot state
 RobotState robotState(*levelLogger, MOTOR_SLEEP);
@@ -36,12 +42,184 @@ RobotLogic robot(motors, sensors, *levelLogger, robotState);
 
 WebServer appServer(8080);      // Main application
 
-// Create web interface with all dependencies
-WebInterface web(appServer, robot, motors, leftMotor, rightMotor, sensors, *webLogger, robotState);
+// Command/telemetry hand-off between the network and control tasks
+ControlLink controlLink;
+
+// esp_timer driven tick for the control task
+ControlTick controlTick(CONTROL_TICK_US);
+
+unsigned long lastGridPublish = 0;  // Control task only
+
+// Create web interface, it only talks to the robot through the control link
+WebInterface web(appServer, controlLink, *webLogger);
 
 // Create OTA manager
 OTAManager ota(*levelLogger, robotState);
 
+// Runs on the control task only, so robot objects are never touched concurrently
+void applyCommand(const RobotCommand& command) {
+    switch (command.type) {
+        case CommandType::SetSpeed:
+            robotState.resetActivityTimer();  // Reset inactivity timer
+            motors.setSpeedPercent(command.value);
+            break;
+        case CommandType::SetSteering:
+            robotState.resetActivityTimer();
+            motors.setSteering(command.value);
+            break;
+        case CommandType::Stop:
+            motors.emergencyStop();
+            break;
+        case CommandType::SetMode:
+            robotState.setMode(command.mode);
+            if (command.mode == OperationMode::Manual) {
+                robotState.resetActivityTimer();
+            } else if (command.mode == OperationMode::Auto) {
+                robot.resetStuckDetection(); // Reset stuck detection when switching to auto
+            }
+            motors.stop();
+            break;
+        case CommandType::Calibrate:
+            motors.startCalibration();
+            break;
+        case CommandType::TestMotors:
+            motors.startTest();
+            break;
+        case CommandType::TestBackup:
+            robot.testBackup();
+            break;
+        case CommandType::SetRangingMode:
+            sensors.setRangingMode(command.ranging);
+            break;
+        case CommandType::ResetOdometry:
+            robot.resetOdometry();
+            break;
+        case CommandType::SetDriveMode:
+            motors.setDriveMode(command.drive);
+            break;
+        case CommandType::ClearCalibration:
+            motors.clearCalibration();
+            break;
+        case CommandType::SetSlewProfile:
+            motors.setSlewProfile(command.slew);
+            break;
+        case CommandType::SetNavigationMode:
+            robot.setNavigationMode(command.navigation);
+            break;
+        case CommandType::SetSpeedGovernor:
+            robot.setGovernorEnabled(command.value != 0);
+            break;
+    }
+}
+
+void publishTelemetry() {
+    RobotTelemetry t;
+    t.mode = robotState.getMode();
+    t.frontDistance = sensors.getFrontDistance();
+    t.leftDistance = sensors.getLeftDistance();
+    t.rightDistance = sensors.getRightDistance();
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        t.captureLatencyUs[i] = sensors.getCaptureLatencyUs(i);
+        t.rawDistance[i] = sensors.getRawDistance(i);
+        t.sensorConfidence[i] = sensors.getConfidence(i);
+        t.sensorAgeMs[i] = sensors.getAge(i);
+    }
+    t.rangingMode = sensors.getRangingMode();
+    t.sensorFrameRate = sensors.getFrameRateHz();
+    t.sensorFrames = sensors.getFrameCount();
+    t.crosstalkRejections = sensors.getCrosstalkRejections();
+    t.outlierRejections = sensors.getOutlierRejections();
+    t.scheduleName = sensors.getScheduleName();
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        t.refreshRateHz[i] = sensors.getRefreshRateHz(i);
+    }
+    t.speedPercent = motors.getSpeedPercent();
+    t.steering = motors.getSteering();
+    t.driveMode = motors.getDriveMode();
+    t.leftSpeed = leftMotor.getVelocityMmS();
+    t.rightSpeed = rightMotor.getVelocityMmS();
+    t.leftTargetSpeed = motors.getLeftTargetMmS();
+    t.rightTargetSpeed = motors.getRightTargetMmS();
+    const Odometry& odometry = robot.getOdometry();
+    t.pose = odometry.getPose();
+    t.linearVelocity = odometry.getLinearVelocity();
+    t.angularVelocity = odometry.getAngularVelocity();
+    t.odometryDistance = odometry.getDistanceTravelled();
+    t.navigationName = robot.getNavigationName();
+    t.vfhDirection = robot.getVfh().getDirection();
+    t.vfhPoints = robot.getVfh().getMemorySize();
+    t.gridReadings = robot.getOccupancyGrid().getUpdates();
+    const SpeedGovernor& governor = robot.getGovernor();
+    t.governorState = governor.getStateName();
+    t.ttcMs = governor.getTtcMs();
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        t.closing[i] = sensors.getClosingMmS(i);
+    }
+    t.governorSensor = governor.getLimitingSensor();
+    t.governorCapPercent = governor.getCapPercent();
+    t.leftScale = motors.getLeftScale();
+    t.rightScale = motors.getRightScale();
+    t.leftCurve = motors.getLeftCurve();
+    t.rightCurve = motors.getRightCurve();
+    t.calibrationStored = motors.isCalibrationStored();
+    t.stuck = robot.isStuck();
+    t.backupRemaining = robot.getBackupTimeRemaining();
+    t.calibrationStatus = motors.getCalibrationStatus();
+    t.calibrationProgress = motors.getCalibrationProgress();
+    t.tickOverruns = controlTick.getOverruns();
+    t.tickMissed = controlTick.getMissedTicks();
+    t.pidMissed = motors.getPidMissedPeriods();
+    t.pidDtUs = motors.getPidDtUs();
+    t.pwmSkipped = motors.getPwmSkipped();
+    t.slewProfile = motors.getSlewProfile();
+    t.motorFaults = motors.getFaultEvents();
+    t.publishedAt = millis();
+    controlLink.publishTelemetry(t);
+}
+
+// Core 1: sensing, PID and navigation at a fixed period
+void controlTask(void*) {
+    if (!controlTick.begin()) {
+        levelLogger->error("Failed to start control tick timer, pacing on the FreeRTOS tick", LogContext::Boot);
+    }
+    for (;;) {
+        controlTick.wait();
+
+        RobotCommand command;
+        while (controlLink.receiveCommand(command)) {
+            applyCommand(command);
+        }
+
+        sensors.setMotionHint(motors.getSpeedPercent(), motors.getSteering());
+        PROFILE(ProfileStage::Sensors, sensors.update());
+        PROFILE(ProfileStage::Motors, motors.update());
+        PROFILE(ProfileStage::Robot, robot.update());
+
+        // Check if we should auto-switch to auto mode
+        if (robotState.shouldSwitchToAuto()) {
+            levelLogger->info("Auto-switching to AUTO mode after inactivity", LogContext::System);
+            robotState.setMode(OperationMode::Auto);
+        }
+
+        publishTelemetry();
+        if (millis() - lastGridPublish >= OCCUPANCY_PUBLISH_INTERVAL) {
+            lastGridPublish = millis();
+            controlLink.publishGrid(robot.getOccupancyGrid());
+        }
+    }
+}
+
+// Core 0: HTTP, OTA and logging, may block without affecting the control loop.
+// The only task that drains the log queue, so the web buffer and LED are never shared
+void networkTask(void*) {
+    for (;;) {
+        PROFILE(ProfileStage::Logger, levelLogger->update());
+        PROFILE(ProfileStage::Ota, ota.update());
+        PROFILE(ProfileStage::Http, appServer.handleClient());
+        vTaskDelay(1);
+    }
+}
+
 void setup() {
     Serial.begin(115200);
     
@@ -72,23 +250,19 @@ void setup() {
     
     levelLogger->info("Web interfaces ready", LogContext::Boot);
     robot.begin();
-    levelLogger->info("System boot complete", LogContext::Boot);
     
-    // Remove timer initialization from here
+    if (!controlLink.begin()) {
+        levelLogger->error("Failed to create command queue", LogContext::Boot);
+    }
+    xTaskCreatePinnedToCore(controlTask, "control", CONTROL_TASK_STACK, nullptr,
+                            CONTROL_TASK_PRIORITY, nullptr, CONTROL_TASK_CORE);
+    xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, nullptr,
+                            NETWORK_TASK_PRIORITY, nullptr, NETWORK_TASK_CORE);
+    levelLogger->info(String("Tuning profile: ") + ACTIVE_TUNING.name, LogContext::Boot);
+    levelLogger->info("System boot complete", LogContext::Boot);
 }
 
 void loop() {
-    sensors.update();
-    motors.update();
-    robot.update();
-    levelLogger->update();
-    
-    // Check if we should auto-switch to auto mode
-    if (robotState.shouldSwitchToAuto()) {
-        levelLogger->info("Auto-switching to AUTO mode after inactivity", LogContext::System);
-        robotState.setMode(OperationMode::Auto);
-    }
-    
-    ota.update();
-    appServer.handleClient();
-}
\ No newline at end of file
+    // All work runs in the pinned control and network tasks
+    vTaskDelete(nullptr);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <Arduino.h>
+#include "../config.h"
+#include "../Odometry.h"
+#include "OccupancyGrid.h"
+
+// Turns what the sensors see into a steering ratio and a speed, once per set
+// of new measurements. RobotLogic owns one of each and switches between them
+// at runtime; stuck detection and backups stay in RobotLogic either way.
+struct NavigationInputs {
+    uint16_t distance[NUM_SENSORS];  // Predicted to now, by SensorIndex
+    bool fresh[NUM_SENSORS];         // A reading came in since the last call
+    float closing[NUM_SENSORS];      // mm/s, > 0 when the gap shrinks
+    Odometry::Pose pose;             // Where the robot is now
+    unsigned long nowMs;
+    const OccupancyGrid* grid;       // Same frame as pose
+};
+
+struct NavigationCommand {
+    float steering;    // -1..1, positive turns right
+    int speedPercent;
+};
+
+class NavigationStrategy {
+public:
+    virtual ~NavigationStrategy() = default;
+    virtual NavigationCommand decide(const NavigationInputs& in) = 0;
+    virtual void reset() {}  // Forget history, e.g. after the odometry frame moved
+    virtual const char* name() const = 0;
+};
@@ -0,0 +1,167 @@
+#include "OccupancyGrid.h"
+
+namespace {
+
+// Steps a ray from cell to cell (Amanatides & Woo), in cell units
+struct CellWalk {
+    int32_t cx, cy;
+    int stepX, stepY;
+    float deltaX, deltaY;  // Ray length per cell crossed
+    float nextX, nextY;    // Ray length to the next cell border
+
+    CellWalk(float fx, float fy, float dx, float dy)
+        : cx(floorf(fx)), cy(floorf(fy)), stepX(dx > 0 ? 1 : -1), stepY(dy > 0 ? 1 : -1),
+          deltaX(dx != 0 ? fabsf(1.0f / dx) : INFINITY), deltaY(dy != 0 ? fabsf(1.0f / dy) : INFINITY),
+          nextX(dx != 0 ? ((dx > 0 ? cx + 1 : cx) - fx) / dx : INFINITY),
+          nextY(dy != 0 ? ((dy > 0 ? cy + 1 : cy) - fy) / dy : INFINITY) {}
+
+    // Into the next cell, returns the ray length where it enters
+    float advance() {
+        if (nextX < nextY) {
+            cx += stepX;
+            nextX += deltaX;
+            return nextX - deltaX;
+        }
+        cy += stepY;
+        nextY += deltaY;
+        return nextY - deltaY;
+    }
+};
+
+}  // namespace
+
+void OccupancyGrid::clear() {
+    memset(cells, UNKNOWN * 0x11, sizeof(cells));
+    centered = false;
+    updates = 0;
+}
+
+bool OccupancyGrid::inWindow(int32_t cx, int32_t cy) const {
+    return cx >= centerX - SIZE / 2 && cx < centerX + SIZE / 2 &&
+           cy >= centerY - SIZE / 2 && cy < centerY + SIZE / 2;
+}
+
+uint8_t OccupancyGrid::get(int32_t cx, int32_t cy) const {
+    int index = (cy & MASK) * SIZE + (cx & MASK);
+    uint8_t pair = cells[index >> 1];
+    return index & 1 ? pair >> 4 : pair & 0x0F;
+}
+
+void OccupancyGrid::set(int32_t cx, int32_t cy, uint8_t value) {
+    int index = (cy & MASK) * SIZE + (cx & MASK);
+    uint8_t& pair = cells[index >> 1];
+    pair = index & 1 ? (pair & 0x0F) | (value << 4) : (pair & 0xF0) | value;
+}
+
+void OccupancyGrid::adjust(int32_t cx, int32_t cy, int delta) {
+    if (!inWindow(cx, cy)) return;
+    set(cx, cy, constrain(get(cx, cy) + delta, UNKNOWN - MAX_LOG_ODDS, UNKNOWN + MAX_LOG_ODDS));
+}
+
+void OccupancyGrid::clearColumn(int32_t cx) {
+    for (int32_t cy = 0; cy < SIZE; cy++) set(cx, cy, UNKNOWN);
+}
+
+void OccupancyGrid::clearRow(int32_t cy) {
+    // A row is contiguous in storage
+    memset(&cells[(cy & MASK) * SIZE / 2], UNKNOWN * 0x11, SIZE / 2);
+}
+
+void OccupancyGrid::recenter(float x, float y) {
+    int32_t cx = toCell(x);
+    int32_t cy = toCell(y);
+    if (!centered) {
+        centerX = cx;
+        centerY = cy;
+        centered = true;
+        return;
+    }
+    if (abs(cx - centerX) >= SIZE || abs(cy - centerY) >= SIZE) {
+        memset(cells, UNKNOWN * 0x11, sizeof(cells));  // Jumped clear out of the window
+    } else {
+        // Whatever scrolls in still holds the cells that scrolled out on the other side
+        for (int32_t c = centerX; c < cx; c++) clearColumn(c + SIZE / 2);
+        for (int32_t c = centerX; c > cx; c--) clearColumn(c - SIZE / 2 - 1);
+        for (int32_t c = centerY; c < cy; c++) clearRow(c + SIZE / 2);
+        for (int32_t c = centerY; c > cy; c--) clearRow(c - SIZE / 2 - 1);
+    }
+    centerX = cx;
+    centerY = cy;
+}
+
+void OccupancyGrid::addReading(float x, float y, float dx, float dy, uint16_t distance) {
+    // No echo only says nothing reflected, the beam can still have grazed a
+    // wall, so only a real echo marks the cells before it free
+    if (!centered || distance == 0 || distance >= MAX_SENSOR_DISTANCE) return;
+
+    float fx = x / OCCUPANCY_CELL_MM;
+    float fy = y / OCCUPANCY_CELL_MM;
+    float length = (float)distance / OCCUPANCY_CELL_MM;
+    int32_t endX = floorf(fx + dx * length);
+    int32_t endY = floorf(fy + dy * length);
+
+    CellWalk walk(fx, fy, dx, dy);
+    int steps = abs(endX - walk.cx) + abs(endY - walk.cy);
+    for (int i = 0; i < steps; i++) {
+        adjust(walk.cx, walk.cy, -OCCUPANCY_MISS);
+        walk.advance();
+    }
+    adjust(endX, endY, OCCUPANCY_HIT);
+    updates++;
+}
+
+void OccupancyGrid::decay(unsigned long nowMs) {
+    if (OCCUPANCY_DECAY_MS <= 0) return;
+    if (nowMs - lastDecay < (unsigned long)OCCUPANCY_DECAY_MS / SIZE) return;
+    lastDecay = nowMs;
+
+    // Storage rows, not world rows: every cell gets its turn either way
+    uint8_t* row = &cells[decayRow * SIZE / 2];
+    for (int i = 0; i < SIZE / 2; i++) {
+        row[i] = fade(row[i] & 0x0F) | (fade(row[i] >> 4) << 4);
+    }
+    decayRow = (decayRow + 1) & MASK;
+}
+
+int OccupancyGrid::getLogOdds(float x, float y) const {
+    int32_t cx = toCell(x);
+    int32_t cy = toCell(y);
+    if (!centered || !inWindow(cx, cy)) return 0;
+    return get(cx, cy) - UNKNOWN;
+}
+
+float OccupancyGrid::castRay(float x, float y, float dx, float dy, float maxMm) const {
+    if (!centered) return maxMm;
+    CellWalk walk(x / OCCUPANCY_CELL_MM, y / OCCUPANCY_CELL_MM, dx, dy);
+    float limit = maxMm / OCCUPANCY_CELL_MM;
+    float t = 0;  // Where the ray entered the current cell
+    while (t < limit && inWindow(walk.cx, walk.cy)) {
+        if ((int)get(walk.cx, walk.cy) - UNKNOWN >= OCCUPANCY_OCCUPIED) {
+            return t * OCCUPANCY_CELL_MM;
+        }
+        t = walk.advance();
+    }
+    return maxMm;
+}
+
+size_t OccupancyGrid::writeBlob(uint8_t* out) const {
+    int32_t originX = centerX - SIZE / 2;
+    int32_t originY = centerY - SIZE / 2;
+    out[0] = 1;
+    out[1] = SIZE;
+    out[2] = OCCUPANCY_CELL_MM & 0xFF;
+    out[3] = OCCUPANCY_CELL_MM >> 8;
+    out[4] = originX & 0xFF;
+    out[5] = (originX >> 8) & 0xFF;
+    out[6] = originY & 0xFF;
+    out[7] = (originY >> 8) & 0xFF;
+
+    // Unrolled from the wrapped storage, lowest row and column first
+    uint8_t* p = out + HEADER_BYTES;
+    for (int32_t cy = originY; cy < originY + SIZE; cy++) {
+        for (int32_t cx = originX; cx < originX + SIZE; cx += 2) {
+            *p++ = get(cx, cy) | (get(cx + 1, cy) << 4);
+        }
+    }
+    return BLOB_BYTES;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+#include "../config.h"
+
+// Local occupancy grid that rolls along with the robot, in the odometry frame.
+// Cells are OCCUPANCY_CELL_MM square and hold a 4-bit log-odds, two per byte,
+// so 64x64 cells take 2KB. Storage wraps around: a world cell lives at its
+// coordinates modulo the grid size, and when the robot crosses into a new cell
+// only the rows/columns that scroll in are cleared. Everything outside the
+// window is unknown.
+//
+// Each echo walks its beam cell by cell: the cells before the echo get
+// OCCUPANCY_MISS off, the echo's cell OCCUPANCY_HIT on. Only the centre of the
+// cone is traced, and readings without an echo are skipped. A beam crosses at
+// most 2 * range / cell cells, so the cost per reading is bounded; recentring
+// clears one row or column per cell moved.
+//
+// Odometry drifts, so old evidence is faded out: decay() steps one row per
+// call towards unknown, spread out so the whole grid takes OCCUPANCY_DECAY_MS.
+//
+// Blob layout for download (writeBlob), little endian:
+//   u8 version (1), u8 cells per side, u16 cell size mm,
+//   i16 x, i16 y of the lower left cell (cell units, odometry frame),
+//   then rows from the lowest y, cells from the lowest x, two per byte,
+//   low nibble first. A nibble is log-odds + 8: 8 unknown, 15 surely occupied,
+//   1 surely free.
+class OccupancyGrid {
+public:
+    static constexpr int SIZE = OCCUPANCY_GRID_SIZE;
+    static constexpr size_t HEADER_BYTES = 8;
+    static constexpr size_t BLOB_BYTES = HEADER_BYTES + SIZE * SIZE / 2;
+
+    OccupancyGrid() { clear(); }
+
+    void clear();
+    void recenter(float x, float y);  // Robot position, mm
+    void addReading(float x, float y, float dx, float dy, uint16_t distance);  // Beam origin, unit direction
+    void decay(unsigned long nowMs);  // Call often, fades at most one row
+
+    int getLogOdds(float x, float y) const;  // -7..7, 0 unknown or outside the window
+    bool isOccupied(float x, float y) const { return getLogOdds(x, y) >= OCCUPANCY_OCCUPIED; }
+    // mm along the ray to the first occupied cell, maxMm when there is none before it
+    float castRay(float x, float y, float dx, float dy, float maxMm) const;
+
+    size_t writeBlob(uint8_t* out) const;  // BLOB_BYTES
+    uint32_t getUpdates() const { return updates; }  // Readings added since the last clear
+
+private:
+    static constexpr int MASK = SIZE - 1;
+    static constexpr int8_t UNKNOWN = 8;
+    static constexpr int8_t MAX_LOG_ODDS = 7;
+    static_assert((SIZE & MASK) == 0, "OCCUPANCY_GRID_SIZE must be a power of 2");
+
+    uint8_t cells[SIZE * SIZE / 2];
+    int32_t centerX = 0;  // Cell the robot is in
+    int32_t centerY = 0;
+    bool centered = false;
+    uint32_t updates = 0;
+    unsigned long lastDecay = 0;
+    int decayRow = 0;
+
+    static int32_t toCell(float mm) { return (int32_t)floorf(mm / OCCUPANCY_CELL_MM); }
+    bool inWindow(int32_t cx, int32_t cy) const;
+    uint8_t get(int32_t cx, int32_t cy) const;
+    void set(int32_t cx, int32_t cy, uint8_t value);
+    void adjust(int32_t cx, int32_t cy, int delta);
+    void clearColumn(int32_t cx);
+    void clearRow(int32_t cy);
+    static uint8_t fade(uint8_t nibble) { return nibble > UNKNOWN ? nibble - 1 : nibble < UNKNOWN ? nibble + 1 : nibble; }
+};
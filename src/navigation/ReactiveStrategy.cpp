@@ -0,0 +1,39 @@
+#include "ReactiveStrategy.h"
+#include "../DistanceSensors.h"
+#include "../NavigationCurves.h"
+
+NavigationCommand ReactiveStrategy::decide(const NavigationInputs& in) {
+    uint16_t front = in.distance[FRONT_SENSOR];
+    uint16_t left = in.distance[LEFT_SENSOR];
+    uint16_t right = in.distance[RIGHT_SENSOR];
+    return {calculateSteering(left, right, front), calculateTargetSpeed(front, left, right)};
+}
+
+float ReactiveStrategy::calculateSteering(uint16_t left, uint16_t right, uint16_t front) {
+    // Normalize distances to 0-1 range (0 = obstacle close, 1 = clear path)
+    float leftClearance = constrain((float)left / MAX_SENSOR_DISTANCE, 0.0f, 1.0f);
+    float rightClearance = constrain((float)right / MAX_SENSOR_DISTANCE, 0.0f, 1.0f);
+
+    // Calculate base steering from side sensors
+    // Use square root to make the response more gentle
+    float steering = (0.3 * rightClearance + (rightClearance, 2)) - (0.3 * leftClearance + (leftClearance, 2));
+
+    // In near-deadzone situations (almost equal side clearances),
+    // pick turn direction based on smallest noise difference
+    if (abs(steering) < 0.05f) {
+        steering = (left < right) ? -0.05f : 0.05f;
+    }
+
+    // Amplify as the front closes in, 1 + 4 * (1 - front/MAX)^4 from the table
+    steering *= NavigationCurves::frontAmplification(front);
+
+    return constrain(steering, -1.0f, 1.0f);
+}
+
+int ReactiveStrategy::calculateTargetSpeed(uint16_t front, uint16_t left, uint16_t right) {
+    // Find minimum distance from all sensors
+    uint16_t minDistance = min(front, min(left, right));
+
+    // Sigmoid speed transition, precomputed in NavigationCurves
+    return NavigationCurves::speed(minDistance);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "NavigationStrategy.h"
+
+// The original formula: steer towards the side with more clearance, harder as
+// the front closes in, speed from the closest of the three readings. Only
+// looks at the current readings.
+class ReactiveStrategy : public NavigationStrategy {
+public:
+    NavigationCommand decide(const NavigationInputs& in) override;
+    const char* name() const override { return "reactive"; }
+
+    // Public so the benchmarks can time them in isolation
+    float calculateSteering(uint16_t left, uint16_t right, uint16_t front);
+    int calculateTargetSpeed(uint16_t front, uint16_t left, uint16_t right);
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+#include "../config.h"
+#include "../Odometry.h"
+
+// Where each sonar sits and looks, by SensorIndex
+struct SensorMount {
+    float forward;  // mm ahead of the wheel axis
+    float lateral;  // mm to the left
+    float angle;    // rad off the heading, positive left
+};
+
+inline constexpr SensorMount SENSOR_MOUNTS[NUM_SENSORS] = {
+    {NAV_SIDE_SENSOR_FORWARD_MM, NAV_SIDE_SENSOR_LATERAL_MM, NAV_SIDE_SENSOR_ANGLE},     // Left
+    {NAV_SIDE_SENSOR_FORWARD_MM, -NAV_SIDE_SENSOR_LATERAL_MM, -NAV_SIDE_SENSOR_ANGLE},  // Right
+    {NAV_FRONT_SENSOR_FORWARD_MM, 0, 0},                                                // Front
+};
+
+// A sensor's beam in the odometry frame
+struct SensorBeam {
+    float x, y;    // Origin, mm
+    float dx, dy;  // Unit direction
+    float angle;
+};
+
+inline SensorBeam sensorBeam(const Odometry::Pose& pose, int sensor) {
+    const SensorMount& mount = SENSOR_MOUNTS[sensor];
+    float c = cosf(pose.theta);
+    float s = sinf(pose.theta);
+    float angle = pose.theta + mount.angle;
+    return {pose.x + mount.forward * c - mount.lateral * s, pose.y + mount.forward * s + mount.lateral * c,
+            cosf(angle), sinf(angle), angle};
+}
@@ -0,0 +1,79 @@
+#include "SpeedGovernor.h"
+#include "../DistanceSensors.h"
+#include "../NavigationCurves.h"
+
+void SpeedGovernor::reset() {
+    state = enabled ? GovernorState::Clear : GovernorState::Off;
+    ttcMs = GOVERNOR_TTC_MAX_MS;
+    limitingSensor = -1;
+    capPercent = MAX_SPEED_PERCENT;
+}
+
+int SpeedGovernor::limit(const NavigationInputs& in, float forwardMmS, int speedPercent) {
+    reset();
+    if (!enabled) {
+        return speedPercent;
+    }
+
+    float forward = max(forwardMmS, 0.0f);
+    // Barely moving, whatever closes in isn't our doing and scaling ~0 down
+    // would only pin the cap to the floor on sensor noise
+    bool capping = forward >= GOVERNOR_MIN_FORWARD_MM_S;
+    // Front reading needed to stop from the cruise speed, short of it there is no lift
+    const float cruiseMmS = GOVERNOR_CRUISE_PERCENT * WHEEL_MAX_SPEED_MM_S / 100.0f;
+    const float cruiseStopMm = GOVERNOR_MARGIN_MM + cruiseMmS * GOVERNOR_LATENCY_MS / 1000.0f +
+                               cruiseMmS * cruiseMmS / (2.0f * GOVERNOR_DECEL_MM_S2);
+    bool frontClear = true;
+    uint16_t nearest = MAX_SENSOR_DISTANCE;
+    float capMmS = INFINITY;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        uint16_t distance = in.distance[i];
+        if (distance == 0 || distance >= MAX_SENSOR_DISTANCE) continue;
+        nearest = min(nearest, distance);
+        float closing = in.closing[i];
+        if (i == FRONT_SENSOR) {
+            closing = max(closing, forward);
+            frontClear = distance > cruiseStopMm;
+        }
+        if (closing < GOVERNOR_MIN_CLOSING_MM_S) continue;
+
+        float gap = distance - GOVERNOR_MARGIN_MM;
+        ttcMs = min(ttcMs, gap > 0 ? (uint32_t)(gap * 1000 / closing) : 0);
+
+        // Gap predicted for when the slowdown takes effect, still closing in at the old rate until then
+        gap -= closing * GOVERNOR_LATENCY_MS / 1000.0f;
+        float allowed = gap > 0 ? sqrtf(2.0f * GOVERNOR_DECEL_MM_S2 * gap) : 0;
+        if (capping && allowed < closing && forward * allowed / closing < capMmS) {
+            capMmS = forward * allowed / closing;
+            limitingSensor = i;
+        }
+    }
+
+    if (limitingSensor >= 0) {
+        capPercent = max(GOVERNOR_MIN_PERCENT, (int)(capMmS * 100 / WHEEL_MAX_SPEED_MM_S));
+        if (capPercent < speedPercent) {
+            state = GovernorState::Limiting;
+            return capPercent;
+        }
+    }
+    // Lift only with nothing inside the strategy's slowdown distance, and never
+    // past what the distance curve allows for the nearest reading
+    if (nearest >= SPEED_THRESHOLD_MM && frontClear && ttcMs >= GOVERNOR_CRUISE_TTC_S * 1000) {
+        int lifted = min(GOVERNOR_CRUISE_PERCENT, min(capPercent, (int)NavigationCurves::speed(nearest)));
+        if (lifted > speedPercent) {
+            state = GovernorState::Cruise;
+            return lifted;
+        }
+    }
+    return speedPercent;
+}
+
+const char* SpeedGovernor::getStateName() const {
+    switch (state) {
+        case GovernorState::Off: return "off";
+        case GovernorState::Clear: return "clear";
+        case GovernorState::Cruise: return "cruise";
+        case GovernorState::Limiting: return "limiting";
+    }
+    return "";
+}
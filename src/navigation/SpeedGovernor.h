@@ -0,0 +1,47 @@
+#pragma once
+#include "NavigationStrategy.h"
+
+enum class GovernorState {
+    Off,       // Strategy speed passes through
+    Clear,     // Nothing closing in soon, strategy speed stands
+    Cruise,    // Nothing closing in for a while, near-obstacle slowdown lifted
+    Limiting   // Capped to stop in time
+};
+
+// Caps the strategy's speed by time to collision instead of distance alone.
+// Per sensor the gap is the reading less GOVERNOR_MARGIN_MM and the distance
+// covered over GOVERNOR_LATENCY_MS, and braking at GOVERNOR_DECEL_MM_S2 allows
+// a closing rate of sqrt(2 * decel * gap). Anything standing still closes in
+// proportionally to the robot's own speed, so the forward speed is scaled by
+// allowed / measured closing rate. The front also gets the static case, as if
+// it were closing at the full forward speed, so a wall that was already close
+// before the rate settled still brakes. The cap goes down to
+// GOVERNOR_MIN_PERCENT, under the distance curve's MIN_SPEED_PERCENT, stopping
+// is left to stuck detection. Below GOVERNOR_MIN_FORWARD_MM_S there is no
+// forward speed to scale and only the TTC is tracked.
+//
+// With no sensor closing in within GOVERNOR_CRUISE_TTC_S, every reading past
+// the strategy's slowdown distance (SPEED_THRESHOLD_MM) and the front far
+// enough to stop from the cruise speed, a slow strategy speed (e.g. VFH easing
+// off for a turn) is raised towards GOVERNOR_CRUISE_PERCENT, but never past
+// what the distance curve gives for the nearest reading.
+class SpeedGovernor {
+public:
+    int limit(const NavigationInputs& in, float forwardMmS, int speedPercent);
+    void reset();
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+    GovernorState getState() const { return state; }
+    const char* getStateName() const;
+    uint32_t getTtcMs() const { return ttcMs; }     // Shortest over the sensors, GOVERNOR_TTC_MAX_MS when none
+    int getLimitingSensor() const { return limitingSensor; }  // SensorIndex, -1 when not limiting
+    int getCapPercent() const { return capPercent; }  // MAX_SPEED_PERCENT when not limiting
+
+private:
+    bool enabled = GOVERNOR_ENABLED;
+    GovernorState state = enabled ? GovernorState::Clear : GovernorState::Off;
+    uint32_t ttcMs = GOVERNOR_TTC_MAX_MS;
+    int limitingSensor = -1;
+    int capPercent = MAX_SPEED_PERCENT;
+};
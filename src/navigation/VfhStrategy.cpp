@@ -0,0 +1,192 @@
+#include "VfhStrategy.h"
+#include "SensorGeometry.h"
+#include "../NavigationCurves.h"
+
+namespace {
+
+constexpr float SECTOR_WIDTH = 2 * PI / VFH_SECTORS;
+constexpr float MERGE_MM = 50;         // A new reading this close to a known point refreshes it
+constexpr float CLEAR_MARGIN_MM = 100; // Known points this much short of an echo get dropped...
+constexpr float CLEAR_CONE = 0.07f;    // ...when within ~4 degrees of the beam, half the real cone
+
+float wrapAngle(float a) {
+    while (a > PI) a -= 2 * PI;
+    while (a < -PI) a += 2 * PI;
+    return a;
+}
+
+int wrapSector(int sector) {
+    return ((sector % VFH_SECTORS) + VFH_SECTORS) % VFH_SECTORS;
+}
+
+}  // namespace
+
+void VfhStrategy::reset() {
+    for (Point& p : memory) p.live = false;
+    memoryHead = 0;
+    for (bool& b : blocked) b = false;
+    hasLastHeading = false;
+    direction = 0;
+}
+
+size_t VfhStrategy::getMemorySize() const {
+    size_t n = 0;
+    for (const Point& p : memory) n += p.live;
+    return n;
+}
+
+float VfhStrategy::sectorAngle(int sector) {
+    return (sector <= VFH_SECTORS / 2 ? sector : sector - VFH_SECTORS) * SECTOR_WIDTH;
+}
+
+void VfhStrategy::remember(float x, float y, unsigned long nowMs) {
+    for (Point& p : memory) {
+        if (p.live && fabsf(p.x - x) < MERGE_MM && fabsf(p.y - y) < MERGE_MM) {
+            p = {x, y, nowMs, true};
+            return;
+        }
+    }
+    memory[memoryHead] = {x, y, nowMs, true};
+    memoryHead = (memoryHead + 1) % VFH_MEMORY_POINTS;
+}
+
+void VfhStrategy::observe(const NavigationInputs& in) {
+    for (int s = 0; s < NUM_SENSORS; s++) {
+        uint16_t d = in.distance[s];
+        // No echo says little, the sides often miss a wall at a glancing angle
+        if (!in.fresh[s] || d == 0 || d >= MAX_SENSOR_DISTANCE) continue;
+
+        SensorBeam beam = sensorBeam(in.pose, s);
+        // Anything remembered well short of the echo along the beam would have
+        // answered first, so it has moved or was never there
+        for (Point& p : memory) {
+            if (!p.live) continue;
+            float along = (p.x - beam.x) * beam.dx + (p.y - beam.y) * beam.dy;
+            float across = fabsf((p.y - beam.y) * beam.dx - (p.x - beam.x) * beam.dy);
+            if (along > 0 && along < d - CLEAR_MARGIN_MM && across < along * CLEAR_CONE) {
+                p.live = false;
+            }
+        }
+        remember(beam.x + d * beam.dx, beam.y + d * beam.dy, in.nowMs);
+    }
+}
+
+void VfhStrategy::buildHistogram(const NavigationInputs& in) {
+    for (int k = 0; k < VFH_SECTORS; k++) {
+        density[k] = 0;
+        nearest[k] = MAX_SENSOR_DISTANCE;
+    }
+    for (Point& p : memory) {
+        if (!p.live) continue;
+        float dx = p.x - in.pose.x;
+        float dy = p.y - in.pose.y;
+        float d = sqrtf(dx * dx + dy * dy);
+        if (in.nowMs - p.timeMs > VFH_MEMORY_AGE_MS || d >= MAX_SENSOR_DISTANCE) {
+            p.live = false;  // Too old, or out of the window
+            continue;
+        }
+        float bearing = wrapAngle(atan2f(dy, dx) - in.pose.theta);
+        float magnitude = 1.0f - d / MAX_SENSOR_DISTANCE;
+        magnitude *= magnitude;
+        // Every direction that would bring the robot's edge within the point
+        float spread = d <= VFH_ROBOT_RADIUS_MM ? PI / 2 : asinf(VFH_ROBOT_RADIUS_MM / d);
+        int first = lroundf((bearing - spread) / SECTOR_WIDTH);
+        int last = lroundf((bearing + spread) / SECTOR_WIDTH);
+        for (int i = first; i <= last; i++) {
+            int k = wrapSector(i);
+            density[k] += magnitude;
+            nearest[k] = min(nearest[k], (uint16_t)d);
+        }
+    }
+    for (int k = 0; k < VFH_SECTORS; k++) {
+        if (density[k] > VFH_THRESHOLD_HIGH) {
+            blocked[k] = true;
+        } else if (density[k] < VFH_THRESHOLD_LOW) {
+            blocked[k] = false;
+        }
+    }
+}
+
+int VfhStrategy::chooseSector(const NavigationInputs& in) const {
+    float previous = hasLastHeading ? wrapAngle(lastHeading - in.pose.theta) : 0;
+    auto cost = [previous](int sector) {
+        float angle = sectorAngle(wrapSector(sector));
+        return VFH_COST_TURN * fabsf(angle) + VFH_COST_CHANGE * fabsf(wrapAngle(angle - previous));
+    };
+
+    int firstBlocked = -1;
+    for (int k = 0; k < VFH_SECTORS; k++) {
+        if (blocked[k]) {
+            firstBlocked = k;
+            break;
+        }
+    }
+    int previousSector = wrapSector(lroundf(previous / SECTOR_WIDTH));
+    if (firstBlocked < 0) {
+        return cost(0) <= cost(previousSector) ? 0 : previousSector;
+    }
+
+    // Valleys of free sectors, walked once round starting after a blocked one.
+    // Narrow: aim for the middle. Wide: the sectors half a wide valley in from
+    // either edge, or straight on / the last direction if they are that far in.
+    int best = -1;
+    float bestCost = 0;
+    auto consider = [&](int sector) {
+        float c = cost(sector);
+        if (best < 0 || c < bestCost) {
+            best = wrapSector(sector);
+            bestCost = c;
+        }
+    };
+    int start = -1;
+    for (int i = firstBlocked + 1; i <= firstBlocked + VFH_SECTORS; i++) {
+        if (!blocked[wrapSector(i)]) {
+            if (start < 0) start = i;
+            continue;
+        }
+        if (start < 0) continue;
+
+        int end = i - 1;
+        if (end - start + 1 < VFH_WIDE_VALLEY) {
+            consider((start + end) / 2);
+        } else {
+            int low = start + VFH_WIDE_VALLEY / 2;
+            int high = end - VFH_WIDE_VALLEY / 2;
+            consider(low);
+            consider(high);
+            for (int target : {0, previousSector}) {
+                for (int unwrapped = target; unwrapped <= high; unwrapped += VFH_SECTORS) {
+                    if (unwrapped >= low) consider(unwrapped);
+                }
+            }
+        }
+        start = -1;
+    }
+    if (best >= 0) return best;
+
+    // Boxed in: the least crowded direction, stuck detection takes it from there
+    best = 0;
+    for (int k = 1; k < VFH_SECTORS; k++) {
+        if (density[k] < density[best]) best = k;
+    }
+    return best;
+}
+
+NavigationCommand VfhStrategy::decide(const NavigationInputs& in) {
+    observe(in);
+    buildHistogram(in);
+    int sector = chooseSector(in);
+
+    direction = sectorAngle(sector);
+    lastHeading = wrapAngle(in.pose.theta + direction);
+    hasLastHeading = true;
+
+    float steering = constrain(-direction / VFH_FULL_STEER_RAD, -1.0f, 1.0f);
+    int speed = MIN_SPEED_PERCENT;
+    if (!blocked[sector]) {
+        // Clearance along the chosen way, then slower the harder it turns
+        float clear = NavigationCurves::speed(nearest[sector]);
+        speed = MIN_SPEED_PERCENT + (clear - MIN_SPEED_PERCENT) * (1.0f - fabsf(steering) / 2);
+    }
+    return {steering, speed};
+}
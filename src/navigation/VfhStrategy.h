@@ -0,0 +1,45 @@
+#pragma once
+#include "NavigationStrategy.h"
+
+// Vector field histogram. Readings become obstacle points in the odometry
+// frame and are kept for a few seconds, so obstacles stay known after they
+// leave a sensor cone. Each call builds a polar density histogram around the
+// robot from those points, each point widened by the robot radius, thresholds
+// it with hysteresis into free/blocked sectors and picks the free direction
+// closest to both the heading and the last choice. That last part is what
+// keeps it from swinging between corridor walls and makes it commit at a
+// corner once it has picked a way round.
+//
+// Fixed memory and bounded time: VFH_MEMORY_POINTS points, each touching at
+// most VFH_SECTORS / 2 + 1 sectors, then one pass over the sectors.
+class VfhStrategy : public NavigationStrategy {
+public:
+    NavigationCommand decide(const NavigationInputs& in) override;
+    void reset() override;
+    const char* name() const override { return "vfh"; }
+
+    size_t getMemorySize() const;                     // Live obstacle points
+    float getDirection() const { return direction; }  // Last chosen, rad off the heading, positive left
+
+private:
+    struct Point {
+        float x, y;  // Odometry frame, mm
+        unsigned long timeMs;
+        bool live;
+    };
+
+    Point memory[VFH_MEMORY_POINTS] = {};
+    size_t memoryHead = 0;
+    float density[VFH_SECTORS] = {};
+    uint16_t nearest[VFH_SECTORS] = {};  // Closest point widened over each sector, mm
+    bool blocked[VFH_SECTORS] = {};
+    float lastHeading = 0;  // Odometry frame, rad
+    bool hasLastHeading = false;
+    float direction = 0;
+
+    void observe(const NavigationInputs& in);
+    void remember(float x, float y, unsigned long nowMs);
+    void buildHistogram(const NavigationInputs& in);
+    int chooseSector(const NavigationInputs& in) const;
+    static float sectorAngle(int sector);
+};
@@ -0,0 +1,73 @@
+#include "../config.h"
+
+#if SENSOR_BACKEND_MCPWM
+
+#include "McpwmEchoSensor.h"
+
+bool IRAM_ATTR McpwmEchoSensor::onCapture(mcpwm_unit_t unit, mcpwm_capture_channel_id_t cap,
+                                          const cap_event_data_t* edata, void* arg) {
+    McpwmEchoSensor* sensor = static_cast<McpwmEchoSensor*>(arg);
+    if (edata->cap_edge == MCPWM_POS_EDGE) {
+        sensor->riseTicks = edata->cap_value;
+        sensor->risen = true;
+    } else if (sensor->risen) {
+        // Unsigned subtraction handles capture timer wrap
+        sensor->pulseTicks = edata->cap_value - sensor->riseTicks;
+        sensor->fallSeenUs = esp_timer_get_time();
+        sensor->risen = false;
+        sensor->echoComplete = true;
+    }
+    return false;  // No task woken
+}
+
+bool McpwmEchoSensor::beginAsync() {
+    pinMode(trigPin, OUTPUT);
+    digitalWrite(trigPin, LOW);
+
+    mcpwm_io_signals_t signal = static_cast<mcpwm_io_signals_t>(MCPWM_CAP_0 + channel);
+    if (mcpwm_gpio_init(UNIT, signal, echoPin) != ESP_OK) {
+        return false;
+    }
+
+    mcpwm_capture_config_t config = {};
+    config.cap_edge = MCPWM_BOTH_EDGE;
+    config.cap_prescale = 1;
+    config.capture_cb = onCapture;
+    config.user_data = this;
+    return mcpwm_capture_enable_channel(UNIT, channel, &config) == ESP_OK;
+}
+
+void McpwmEchoSensor::startAsync(uint32_t timeout) {
+    risen = false;
+    echoComplete = false;
+    finished = false;
+    distance = 0;
+    timeoutUs = timeout;
+
+    digitalWrite(trigPin, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(trigPin, LOW);
+    startUs = esp_timer_get_time();
+}
+
+bool McpwmEchoSensor::isFinished() {
+    if (finished) {
+        return true;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (echoComplete) {
+        uint32_t pulseUs = pulseTicks / TICKS_PER_US;
+        // Echoes longer than the timeout are outside the configured range
+        distance = pulseUs <= timeoutUs ? pulseUs * 343UL / 2000UL : 0;
+        captureLatencyUs = now - fallSeenUs;
+        finished = true;
+    } else if (now - startUs >= timeoutUs) {
+        distance = 0;
+        captureLatencyUs = 0;
+        finished = true;
+    }
+    return finished;
+}
+
+#endif
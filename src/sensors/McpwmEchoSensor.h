@@ -0,0 +1,46 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/mcpwm.h>
+#include <esp_timer.h>
+
+// HC-SR04 backend on the MCPWM capture unit. Both echo edges are latched by
+// the capture timer in hardware, so the pulse width (and range) is unaffected
+// by ISR latency from WiFi or the encoder interrupts. Drop-in for the
+// HC_SR04 library's async API as used by DistanceSensors.
+class McpwmEchoSensor {
+private:
+    const int trigPin;
+    const int echoPin;
+    const mcpwm_capture_channel_id_t channel;
+
+    // Written from the capture ISR
+    volatile uint32_t riseTicks = 0;
+    volatile uint32_t pulseTicks = 0;
+    volatile int64_t fallSeenUs = 0;  // esp_timer time the falling edge reached the ISR
+    volatile bool risen = false;
+    volatile bool echoComplete = false;
+
+    int64_t startUs = 0;
+    uint32_t timeoutUs = 0;
+    bool finished = true;
+    uint16_t distance = 0;
+    uint32_t captureLatencyUs = 0;
+
+    static bool IRAM_ATTR onCapture(mcpwm_unit_t unit, mcpwm_capture_channel_id_t cap,
+                                    const cap_event_data_t* edata, void* arg);
+
+public:
+    static constexpr mcpwm_unit_t UNIT = MCPWM_UNIT_0;
+    static constexpr uint32_t TICKS_PER_US = 80;  // Capture timer runs from APB (80MHz)
+
+    McpwmEchoSensor(int trig, int echo, mcpwm_capture_channel_id_t cap)
+        : trigPin(trig), echoPin(echo), channel(cap) {}
+
+    bool beginAsync();
+    void startAsync(uint32_t timeout);
+    bool isFinished();
+    uint16_t getDist_mm() const { return distance; }  // 0 when there was no echo
+
+    // Time from the end of the echo to the sample being picked up by isFinished()
+    uint32_t getCaptureLatencyUs() const { return captureLatencyUs; }
+};
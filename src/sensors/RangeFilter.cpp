@@ -0,0 +1,105 @@
+#include "RangeFilter.h"
+
+void RangeFilter::reset() {
+    *this = RangeFilter();
+}
+
+bool RangeFilter::update(uint16_t raw, unsigned long now) {
+    if (raw == 0) {
+        updateConfidence(false);
+        if (missedEchoes < SENSOR_NO_ECHO_LIMIT) {
+            missedEchoes++;
+        }
+        // Nothing in range for a while, that is a reading too
+        if (missedEchoes >= SENSOR_NO_ECHO_LIMIT && distance != MAX_SENSOR_DISTANCE) {
+            restart(MAX_SENSOR_DISTANCE, now);
+            return true;
+        }
+        return false;
+    }
+    missedEchoes = 0;
+
+    uint16_t value = min(raw, (uint16_t)MAX_SENSOR_DISTANCE);
+    if (!hasEstimate) {
+        restart(value, now);
+        updateConfidence(true);
+        return true;
+    }
+
+    if (SENSOR_MAX_RATE_MM_S > 0) {
+        // Past the time to cross the whole range any jump is allowed, clamping keeps the product from overflowing
+        const uint32_t fullRangeMs = (uint32_t)MAX_SENSOR_DISTANCE * 1000 / max(SENSOR_MAX_RATE_MM_S, 1) + 1;
+        uint32_t elapsed = min((uint32_t)(now - lastAccepted), fullRangeMs);
+        uint32_t allowed = (uint32_t)SENSOR_MAX_RATE_MM_S * elapsed / 1000 + SENSOR_GATE_MARGIN_MM;
+        if ((uint32_t)abs((int32_t)value - (int32_t)distance) > allowed) {
+            if (pendingCount > 0 && abs((int32_t)value - (int32_t)pendingOutlier) <= SENSOR_GATE_MARGIN_MM) {
+                pendingCount++;
+            } else {
+                pendingCount = 1;
+            }
+            pendingOutlier = value;
+
+            if (pendingCount < SENSOR_GATE_CONFIRM) {
+                rejected++;
+                updateConfidence(false);
+                return false;
+            }
+            restart(value, now);
+            updateConfidence(true);
+            return true;
+        }
+    }
+
+    pendingCount = 0;
+    accept(value, now);
+    updateConfidence(true);
+    return true;
+}
+
+void RangeFilter::accept(uint16_t value, unsigned long now) {
+    window[windowIndex] = value;
+    windowIndex = (windowIndex + 1) % SENSOR_MEDIAN_WINDOW;
+    if (windowCount < SENSOR_MEDIAN_WINDOW) {
+        windowCount++;
+    }
+
+    float filtered = median();
+    if (SENSOR_KALMAN) {
+        float dt = (now - lastAccepted) / 1000.0f;
+        kalmanVariance += SENSOR_KALMAN_Q * dt;
+        float gain = kalmanVariance / (kalmanVariance + SENSOR_KALMAN_R);
+        kalmanEstimate += gain * (filtered - kalmanEstimate);
+        kalmanVariance *= 1.0f - gain;
+        filtered = kalmanEstimate;
+    }
+
+    distance = constrain((long)lroundf(filtered), 0L, (long)MAX_SENSOR_DISTANCE);
+    lastAccepted = now;
+}
+
+void RangeFilter::restart(uint16_t value, unsigned long now) {
+    window[0] = value;
+    windowCount = 1;
+    windowIndex = 1 % SENSOR_MEDIAN_WINDOW;
+    kalmanEstimate = value;
+    kalmanVariance = SENSOR_KALMAN_R;
+    pendingCount = 0;
+    distance = value;
+    lastAccepted = now;
+    hasEstimate = true;
+}
+
+uint16_t RangeFilter::median() const {
+    // Insertion sort, at most MAX_WINDOW values
+    uint16_t sorted[MAX_WINDOW];
+    for (uint8_t i = 0; i < windowCount; i++) {
+        uint16_t v = window[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[windowCount / 2];
+}
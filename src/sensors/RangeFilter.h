@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+#include "../config.h"
+
+// Per-sensor cleanup between the raw echo and everything that navigates on it.
+// Fixed memory, one update per raw reading:
+//
+// - Missing echoes hold the last value, only SENSOR_NO_ECHO_LIMIT misses in a
+//   row report MAX_SENSOR_DISTANCE.
+// - Rate gate: a reading further from the estimate than the robot could have
+//   moved since the last accepted one is dropped. SENSOR_GATE_CONFIRM
+//   consistent outliers in a row are a real step and restart the filter there.
+// - Running median over the last SENSOR_MEDIAN_WINDOW accepted readings.
+// - Optional 1D Kalman (constant distance + process noise) on the median.
+//
+// Confidence is a moving average of accepted readings (1) vs misses and
+// outliers (0), so it drops quickly on a flaky sensor.
+class RangeFilter {
+public:
+    static constexpr size_t MAX_WINDOW = 5;
+    static_assert(SENSOR_MEDIAN_WINDOW >= 1 && SENSOR_MEDIAN_WINDOW <= MAX_WINDOW,
+                  "SENSOR_MEDIAN_WINDOW must be 1..5");
+
+    bool update(uint16_t raw, unsigned long now);  // raw 0 = no echo, true when the estimate moved to it
+    void reset();
+
+    uint16_t getDistance() const { return distance; }  // 0 until the first reading
+    float getConfidence() const { return confidence; } // 0-1
+    unsigned long getAge(unsigned long now) const { return hasEstimate ? now - lastAccepted : 0; }
+    uint32_t getRejected() const { return rejected; }
+
+private:
+    static constexpr float CONFIDENCE_ALPHA = 0.25f;
+
+    uint16_t window[MAX_WINDOW] = {0};
+    uint8_t windowCount = 0;
+    uint8_t windowIndex = 0;
+    uint16_t distance = 0;
+    float confidence = 0;
+    unsigned long lastAccepted = 0;
+    bool hasEstimate = false;
+
+    uint8_t missedEchoes = 0;
+    uint16_t pendingOutlier = 0;
+    uint8_t pendingCount = 0;
+    uint32_t rejected = 0;
+
+    float kalmanEstimate = 0;
+    float kalmanVariance = 0;
+
+    void accept(uint16_t value, unsigned long now);
+    void restart(uint16_t value, unsigned long now);
+    void updateConfidence(bool hit) { confidence += CONFIDENCE_ALPHA * ((hit ? 1.0f : 0.0f) - confidence); }
+    uint16_t median() const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <Arduino.h>
+
+// Fixed-size ring of timestamped range samples, newest first on read.
+// Timestamps are micros() and only ever compared as differences, so the
+// 71 minute wrap doesn't matter.
+template<size_t N>
+class SampleRing {
+public:
+    struct Sample {
+        uint32_t timeUs;
+        uint16_t distance;
+    };
+
+    void push(uint32_t timeUs, uint16_t distance) {
+        samples[head] = {timeUs, distance};
+        head = (head + 1) % N;
+        if (count < N) count++;
+    }
+
+    void clear() { count = 0; head = 0; }
+    size_t size() const { return count; }
+
+    // 0 = newest
+    const Sample& operator[](size_t age) const { return samples[(head + N - 1 - age) % N]; }
+
+    // Least-squares slope in mm/s over samples no older than windowUs before
+    // the newest and below maxDistance (no-echo samples say nothing about
+    // motion). False when there are fewer than minSamples to fit, or when the
+    // samples sit further than maxResidual (RMS, mm) from the line: an edge
+    // entering the cone or a change of direction, not something to extrapolate.
+    bool fitSlope(uint32_t windowUs, uint16_t maxDistance, size_t minSamples, float maxResidual,
+                  float& slope) const {
+        if (count == 0) return false;
+        uint32_t newest = (*this)[0].timeUs;
+
+        float sumT = 0, sumD = 0, sumTT = 0, sumTD = 0, sumDD = 0;
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            const Sample& s = (*this)[i];
+            uint32_t back = newest - s.timeUs;
+            if (back > windowUs) break;
+            if (s.distance >= maxDistance) continue;
+            float t = -(float)back / 1000000.0f;
+            float d = s.distance;
+            sumT += t;
+            sumD += d;
+            sumTT += t * t;
+            sumTD += t * d;
+            sumDD += d * d;
+            n++;
+        }
+        if (n < minSamples) return false;
+
+        float denom = n * sumTT - sumT * sumT;
+        if (denom <= 0) return false;
+        float b = (n * sumTD - sumT * sumD) / denom;
+        float a = (sumD - b * sumT) / n;
+
+        // Sum of squared residuals from the sums, no second pass
+        float residual = sumDD - a * sumD - b * sumTD;
+        if (residual > maxResidual * maxResidual * n) return false;
+
+        slope = b;
+        return true;
+    }
+
+private:
+    Sample samples[N] = {};
+    size_t head = 0;
+    size_t count = 0;
+};
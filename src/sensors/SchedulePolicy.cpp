@@ -0,0 +1,32 @@
+#include "SchedulePolicy.h"
+
+SensorPlan AdaptiveSchedule::plan(const ScheduleInputs& in) {
+    SensorPlan plan;
+
+    uint8_t sidesEvery;
+    if (fabs(in.steering) > SCHED_SIDES_STEERING) {
+        sidesEvery = 1;
+    } else if (in.speedPercent >= SCHED_CRUISE_SPEED || in.frontClosingMmS > SCHED_CLOSING_MM_S) {
+        sidesEvery = 3;
+    } else if (in.speedPercent >= MIN_SPEED_PERCENT) {
+        sidesEvery = 2;
+    } else {
+        sidesEvery = 1;
+    }
+
+    framesSinceSides++;
+    plan.fireSides = framesSinceSides >= sidesEvery;
+    if (plan.fireSides) {
+        framesSinceSides = 0;
+    }
+
+    // Keep seeing whatever is already in front, or it drops out of range and
+    // the robot speeds up towards it
+    float speed = constrain(in.speedPercent, 0.0f, 100.0f) / 100.0f;
+    uint16_t range = SCHED_MIN_FRONT_RANGE + (MAX_SENSOR_DISTANCE - SCHED_MIN_FRONT_RANGE) * speed;
+    if (in.frontDistance > 0 && in.frontDistance < MAX_SENSOR_DISTANCE) {
+        range = max(range, (uint16_t)min(in.frontDistance + 200, MAX_SENSOR_DISTANCE));
+    }
+    plan.frontRangeMm = range;
+    return plan;
+}
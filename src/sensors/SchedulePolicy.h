@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+#include "../config.h"
+
+// Decides per ranging frame which sensors fire and how far they need to see.
+// The side pair always fires together (see DistanceSensors), so a plan is
+// just sides yes/no, front yes/no and a range for each. Shorter range means
+// a shorter echo timeout.
+struct ScheduleInputs {
+    float speedPercent;      // MotorController::getSpeedPercent()
+    float steering;          // MotorController::getSteering(), -1..1
+    uint16_t frontDistance;  // Filtered
+    float frontClosingMmS;   // > 0 when the front gap is shrinking
+};
+
+struct SensorPlan {
+    bool fireSides = true;
+    bool fireFront = true;
+    uint16_t sideRangeMm = MAX_SENSOR_DISTANCE;
+    uint16_t frontRangeMm = MAX_SENSOR_DISTANCE;
+};
+
+class SchedulePolicy {
+public:
+    virtual ~SchedulePolicy() = default;
+    virtual SensorPlan plan(const ScheduleInputs& in) = 0;
+    virtual const char* name() const = 0;
+};
+
+// Every sensor every frame at full range
+class EqualSchedule : public SchedulePolicy {
+public:
+    SensorPlan plan(const ScheduleInputs&) override { return SensorPlan(); }
+    const char* name() const override { return "equal"; }
+};
+
+// Front every frame. Sides every frame when steering hard or slow, every
+// second frame in between, every third at cruise or when closing in on
+// something in front. Front range scales with speed.
+class AdaptiveSchedule : public SchedulePolicy {
+private:
+    uint8_t framesSinceSides = 0;
+
+public:
+    SensorPlan plan(const ScheduleInputs& in) override;
+    const char* name() const override { return "adaptive"; }
+};
@@ -0,0 +1,170 @@
+// SteeringMixerQ16 against the float SteeringMixer, see SteeringMixer.h, and
+// SpeedGovernor on a few hand-built approaches
+//   pio test -e native_test
+#include <unity.h>
+#include "SteeringMixer.h"
+#include "DistanceSensors.h"
+#include "navigation/SpeedGovernor.h"
+
+namespace {
+
+constexpr float CORRECTION_TOLERANCE = 0.0011f;
+constexpr int PWM_TOLERANCE = 1;  // Counts
+// mm/s, correction tolerance at full speed plus a Q4 step
+constexpr float ZERO_SPEED_BAND = WHEEL_MAX_SPEED_MM_S * CORRECTION_TOLERANCE + 1.0f / (1 << SteeringMixerQ16::SPEED_SHIFT);
+constexpr int RUNS = 20000;
+constexpr int STEPS = 50;         // PID updates per run
+constexpr int MAX_SPLIT_RUNS = RUNS / 100;  // Runs that hit the integral reset ambiguity
+
+// Deterministic xorshift, same sequence every run
+uint32_t rngState = 12345;
+uint32_t next() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+float uniform(float lo, float hi) { return lo + (hi - lo) * (next() % 100001) / 100000.0f; }
+
+// mm/s on the Q4 grid, so both versions see exactly the same speed
+float gridSpeed(float mmS) {
+    return SteeringMixerQ16::speed(mmS) / (float)(1 << SteeringMixerQ16::SPEED_SHIFT);
+}
+
+// Calibration-like curve: deadband, then rising speed
+SpeedCurve randomCurve() {
+    float pwm[MOTOR_CURVE_POINTS];
+    float speed[MOTOR_CURVE_POINTS];
+    float top = uniform(300, 500);
+    for (size_t i = 0; i < MOTOR_CURVE_POINTS; i++) {
+        pwm[i] = 100.0f * (i + 1) / MOTOR_CURVE_POINTS;
+        speed[i] = i == 0 ? 0 : top * (i + uniform(-0.3f, 0.3f)) / (MOTOR_CURVE_POINTS - 1);
+    }
+    SpeedCurve curve;
+    curve.setPoints(pwm, speed, MOTOR_CURVE_POINTS);
+    return curve;
+}
+
+struct Worst {
+    float correction = 0;
+    int pwm = 0;
+    int splitRuns = 0;  // Ended early, see below
+};
+
+void compare(bool curves, Worst& worst) {
+    for (int run = 0; run < RUNS; run++) {
+        SteeringMixer reference;
+        SteeringMixerQ16 fixed;
+
+        float ratio = uniform(-1, 1);
+        float percent = uniform(-100, 100);
+        reference.setTarget(ratio, percent);
+        fixed.setTarget(ratio, percent);
+
+        float leftScale = uniform(0.6f, 1);
+        float rightScale = uniform(0.6f, 1);
+        reference.setScales(leftScale, rightScale);
+        fixed.setScales(leftScale, rightScale);
+        if (curves) {
+            SpeedCurve left = randomCurve();
+            SpeedCurve right = randomCurve();
+            reference.setCurves(left, right);
+            fixed.setCurves(left, right);
+        }
+
+        float base = uniform(0, 450);
+        for (int step = 0; step < STEPS; step++) {
+            float leftSpeed = gridSpeed(base + uniform(-40, 40));
+            float rightSpeed = gridSpeed(base + uniform(-40, 40));
+            uint32_t dtUs = STEERING_PID_INTERVAL_US + (next() % 4001) - 2000;
+
+            SteeringMixer::Output a = reference.update(fabsf(leftSpeed), fabsf(rightSpeed), dtUs);
+            SteeringMixerQ16::Output b = fixed.update(SteeringMixerQ16::speed(fabsf(leftSpeed)),
+                                                      SteeringMixerQ16::speed(fabsf(rightSpeed)), dtUs);
+
+            worst.correction = max(worst.correction, fabsf(a.correction - Q16::toFloat(b.correction)));
+            // A wheel asked for about 0 mm/s, within what the rounding can move it, can land
+            // on either side of the curve's step from 0 to the deadband edge
+            float speed = fabsf(percent) / 100.0f * WHEEL_MAX_SPEED_MM_S;
+            bool leftAtZero = curves && speed * (1.0f + a.correction) < ZERO_SPEED_BAND;
+            bool rightAtZero = curves && speed * (1.0f - a.correction) < ZERO_SPEED_BAND;
+            if (!leftAtZero) worst.pwm = max(worst.pwm, abs(a.left - b.left));
+            if (!rightAtZero) worst.pwm = max(worst.pwm, abs(a.right - b.right));
+
+            // Error rounded to opposite signs: the next step resets the integral in only
+            // one of them, from there on they take different paths, not a precision issue
+            if (signbit(reference.getLastError()) != (fixed.getLastError() < 0)) {
+                worst.splitRuns++;
+                break;
+            }
+        }
+    }
+}
+
+void test_scales_match_float() {
+    Worst worst;
+    compare(false, worst);
+    TEST_ASSERT_FLOAT_WITHIN(CORRECTION_TOLERANCE, 0, worst.correction);
+    TEST_ASSERT_LESS_OR_EQUAL_INT(PWM_TOLERANCE, worst.pwm);
+    TEST_ASSERT_LESS_OR_EQUAL_INT(MAX_SPLIT_RUNS, worst.splitRuns);
+}
+
+void test_curves_match_float() {
+    Worst worst;
+    compare(true, worst);
+    TEST_ASSERT_FLOAT_WITHIN(CORRECTION_TOLERANCE, 0, worst.correction);
+    TEST_ASSERT_LESS_OR_EQUAL_INT(PWM_TOLERANCE, worst.pwm);
+    TEST_ASSERT_LESS_OR_EQUAL_INT(MAX_SPLIT_RUNS, worst.splitRuns);
+}
+
+// Nothing in range on any sensor
+NavigationInputs openField() {
+    NavigationInputs in = {};
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        in.distance[i] = MAX_SENSOR_DISTANCE;
+        in.fresh[i] = true;
+    }
+    return in;
+}
+
+void test_governor_slow_approach_not_lifted() {
+    SpeedGovernor governor;
+    governor.setEnabled(true);
+    NavigationInputs in = openField();
+    in.distance[FRONT_SENSOR] = 150;
+    in.closing[FRONT_SENSOR] = 20;  // Below GOVERNOR_MIN_CLOSING_MM_S
+    in.closing[LEFT_SENSOR] = 120;  // Noise, nothing in range there
+    TEST_ASSERT_LESS_OR_EQUAL_INT(MIN_SPEED_PERCENT, governor.limit(in, 30, MIN_SPEED_PERCENT));
+    TEST_ASSERT_LESS_OR_EQUAL_INT(MIN_SPEED_PERCENT, governor.limit(in, 0, MIN_SPEED_PERCENT));
+}
+
+void test_governor_fast_approach_limits() {
+    SpeedGovernor governor;
+    governor.setEnabled(true);
+    NavigationInputs in = openField();
+    in.distance[FRONT_SENSOR] = 200;
+    in.closing[FRONT_SENSOR] = 350;
+    TEST_ASSERT_LESS_THAN_INT(MAX_SPEED_PERCENT, governor.limit(in, 350, MAX_SPEED_PERCENT));
+    TEST_ASSERT_EQUAL_INT((int)GovernorState::Limiting, (int)governor.getState());
+}
+
+void test_governor_open_field_cruises() {
+    SpeedGovernor governor;
+    governor.setEnabled(true);
+    NavigationInputs in = openField();
+    int requested = GOVERNOR_CRUISE_PERCENT - 20;  // e.g. VFH slowing for a turn
+    TEST_ASSERT_EQUAL_INT(GOVERNOR_CRUISE_PERCENT, governor.limit(in, 200, requested));
+    TEST_ASSERT_EQUAL_INT((int)GovernorState::Cruise, (int)governor.getState());
+}
+
+}  // namespace
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_scales_match_float);
+    RUN_TEST(test_curves_match_float);
+    RUN_TEST(test_governor_slow_approach_not_lifted);
+    RUN_TEST(test_governor_fast_approach_limits);
+    RUN_TEST(test_governor_open_field_cruises);
+    return UNITY_END();
+}